@@ -20,17 +20,19 @@
  */
 
 #pragma once
+#include <tuple>
 
 #include "common/bitlist.hpp"
 #include "common/containers.hpp"
 #include "config.hpp"
+#include "ssz/schema.hpp"
 #include "ssz/ssz.hpp"
 #include "yaml-cpp/yaml.h"
 
 namespace eth {
 class BeaconState;
 
-struct AttestationData : public ssz::Container {
+struct AttestationData : public ssz::SchemaContainer<AttestationData> {
     Slot slot;
     CommitteeIndex index;
 
@@ -38,54 +40,50 @@ struct AttestationData : public ssz::Container {
     Checkpoint source, target;
 
     static constexpr std::size_t ssz_size = 128;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-    std::vector<ssz::Chunk> hash_tree() const override;
-    BytesVector serialize() const override;
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override;
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("slot", &AttestationData::slot), ssz::field("index", &AttestationData::index),
+                          ssz::field("beacon_block_root", &AttestationData::beacon_block_root),
+                          ssz::field("source", &AttestationData::source),
+                          ssz::field("target", &AttestationData::target)};
+    }
     bool is_slashable(const AttestationData&) const;
-
-    YAML::Node encode() const override;
-    bool decode(const YAML::Node &node) override;
 };
 
-struct IndexedAttestation : public ssz::Container {
+struct IndexedAttestation : public ssz::SchemaContainer<IndexedAttestation> {
     ListFixedSizedParts<ValidatorIndex> attesting_indices{constants::MAX_VALIDATORS_PER_COMMITTEE};
     AttestationData data;
     BLSSignature signature;
 
-    std::vector<ssz::Chunk> hash_tree() const override;
-    BytesVector serialize() const override;
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override;
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("attesting_indices", &IndexedAttestation::attesting_indices),
+                          ssz::field("data", &IndexedAttestation::data),
+                          ssz::field("signature", &IndexedAttestation::signature)};
+    }
     bool is_valid(const eth::BeaconState& state) const; 
-
-    YAML::Node encode() const override;
-    bool decode(const YAML::Node &node) override;
 };
 
-struct PendingAttestation : public ssz::Container {
+struct PendingAttestation : public ssz::SchemaContainer<PendingAttestation> {
     eth::Bitlist aggregation_bits{constants::MAX_VALIDATORS_PER_COMMITTEE};
     AttestationData data;
     Slot inclusion_delay;
     ValidatorIndex proposer_index;
 
-    std::vector<ssz::Chunk> hash_tree() const override;
-    BytesVector serialize() const override;
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override;
-
-    YAML::Node encode() const override;
-    bool decode(const YAML::Node &node) override;
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("aggregation_bits", &PendingAttestation::aggregation_bits),
+                          ssz::field("data", &PendingAttestation::data),
+                          ssz::field("inclusion_delay", &PendingAttestation::inclusion_delay),
+                          ssz::field("proposer_index", &PendingAttestation::proposer_index)};
+    }
 };
 
-struct Attestation : public ssz::Container {
+struct Attestation : public ssz::SchemaContainer<Attestation> {
     eth::Bitlist aggregation_bits{constants::MAX_VALIDATORS_PER_COMMITTEE};
     AttestationData data;
     BLSSignature signature;
 
-    std::vector<ssz::Chunk> hash_tree() const override;
-    BytesVector serialize() const override;
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override;
-    
-    YAML::Node encode() const override;
-    bool decode(const YAML::Node &node) override;
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("aggregation_bits", &Attestation::aggregation_bits),
+                          ssz::field("data", &Attestation::data), ssz::field("signature", &Attestation::signature)};
+    }
 };
 };  // namespace eth
@@ -0,0 +1,76 @@
+/*  attestation_packer.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "beacon-chain/attestation_packer.hpp"
+
+#include <algorithm>
+
+namespace eth {
+Bitlist *AttestationPacker::committee(const AttestationData &data, std::size_t size) {
+    auto [it, inserted] = covered_.try_emplace({data.slot, data.index}, constants::MAX_VALIDATORS_PER_COMMITTEE);
+    if (inserted) it->second.resize(size);
+    return it->second.size() == size ? &it->second : nullptr;
+}
+
+void AttestationPacker::cover(const AttestationData &data, const Bitlist &bits) {
+    if (auto *covered = committee(data, bits.size())) *covered |= bits;
+}
+
+std::vector<Attestation> AttestationPacker::pack(std::span<const Attestation> candidates, std::size_t max) {
+    // A max heap on the gains, that are upper bounds of the actual ones, the first candidate wins ties
+    struct Candidate {
+        std::size_t gain, index;
+        bool operator<(const Candidate &other) const {
+            return gain < other.gain || (gain == other.gain && index > other.index);
+        }
+    };
+    std::vector<Candidate> heap;
+    std::vector<Bitlist *> committees(candidates.size());
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        const auto &candidate = candidates[i];
+        if (!includable(candidate.data)) continue;
+        committees[i] = committee(candidate.data, candidate.aggregation_bits.size());
+        if (!committees[i]) continue;
+        if (auto gain = candidate.aggregation_bits.count_not_in(*committees[i])) heap.push_back({gain, i});
+    }
+    std::make_heap(heap.begin(), heap.end());
+
+    std::vector<Attestation> ret;
+    while (ret.size() < max && !heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end());
+        auto top = heap.back();
+        heap.pop_back();
+        const auto &bits = candidates[top.index].aggregation_bits;
+        auto &covered = *committees[top.index];
+        top.gain = bits.count_not_in(covered);
+        if (!top.gain) continue;
+        // No other candidate can do better than its bound
+        if (heap.empty() || !(top < heap.front())) {
+            covered |= bits;
+            ret.push_back(candidates[top.index]);
+            continue;
+        }
+        heap.push_back(top);
+        std::push_heap(heap.begin(), heap.end());
+    }
+    return ret;
+}
+}  // namespace eth
@@ -0,0 +1,76 @@
+/*  attestation_packer.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "beacon-chain/attestation.hpp"
+#include "common/bitlist.hpp"
+#include "config/constants.hpp"
+#include "include/config.hpp"
+
+namespace eth {
+/**
+ *   \brief Chooses the attestations of a block to include the most new attesters.
+ *   \details Attesters are identified by the slot and committee index of the data and their bit, so that
+ *   attestations of the same committee voting for different data cover the same validators. The choice is the
+ *   greedy approximation of maximum coverage, made lazy: gains only decrease as attesters are covered, so that a
+ *   candidate whose gain is still the largest after recomputing it is the best one and the others are not looked at.
+ *   Candidates outside the inclusion window of the slot of the block are skipped.
+ */
+class AttestationPacker {
+   private:
+    using Committee = std::pair<std::uint64_t, std::uint64_t>;  // slot and index
+    struct CommitteeHash {
+        std::size_t operator()(const Committee &committee) const noexcept {
+            return committee.first * constants::MAX_COMMITTEES_PER_SLOT + committee.second;
+        }
+    };
+
+    Slot slot_;
+    std::unordered_map<Committee, Bitlist, CommitteeHash> covered_;
+
+    // The attesters covered of the committee of data, nullptr if it has not size members
+    Bitlist *committee(const AttestationData &data, std::size_t size);
+
+   public:
+    // Packs the block of slot
+    explicit AttestationPacker(Slot slot) : slot_{slot} {}
+
+    bool includable(const AttestationData &data) const {
+        return data.slot + constants::MIN_ATTESTATION_INCLUSION_DELAY <= slot_ &&
+               slot_ <= data.slot + constants::SLOTS_PER_EPOCH;
+    }
+
+    // Attesters already on chain, as those of the pending attestations of the state, add nothing
+    void cover(const AttestationData &data, const Bitlist &bits);
+
+    // Up to max candidates in the order they are chosen, each one adding at least one attester. Their attesters are
+    // covered for the next calls.
+    std::vector<Attestation> pack(std::span<const Attestation> candidates,
+                                  std::size_t max = constants::MAX_ATTESTATIONS);
+};
+}  // namespace eth
@@ -0,0 +1,144 @@
+/*  attestation_pool.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "beacon-chain/attestation_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace eth {
+AttestationPool::Result AttestationPool::insert(const Attestation &attestation, const ssz::Chunk &data_root) {
+    const auto &bits = attestation.aggregation_bits;
+    if (bits.none()) return Result::invalid;
+    auto &s = shard(data_root);
+    std::lock_guard lock{s.mutex};
+    auto entry = s.entries.find(data_root);
+    if (entry == s.entries.end()) {
+        if (data_.fetch_add(1, std::memory_order_relaxed) >= limits_.data) {
+            data_.fetch_sub(1, std::memory_order_relaxed);
+            return Result::full;
+        }
+        entry = s.entries.emplace(data_root, Entry{attestation.data.slot, {}}).first;
+    }
+    return insert(entry->second, attestation);
+}
+
+AttestationPool::Result AttestationPool::insert(Entry &entry, const Attestation &attestation) {
+    const auto &bits = attestation.aggregation_bits;
+    auto &aggregates = entry.aggregates;
+    if (!aggregates.empty() && aggregates.front().aggregation_bits.size() != bits.size()) return Result::invalid;
+
+    // The largest aggregate that it does not overlap
+    Attestation *target = nullptr;
+    std::size_t target_count = 0;
+    for (auto &aggregate : aggregates) {
+        if (bits.is_subset_of(aggregate.aggregation_bits)) return Result::known;
+        if (aggregate.aggregation_bits.intersects(bits)) continue;
+        auto count = aggregate.aggregation_bits.count();
+        if (!target || count > target_count) {
+            target = &aggregate;
+            target_count = count;
+        }
+    }
+
+    auto result = Result::merged;
+    if (target) {
+        target->aggregation_bits |= bits;
+        if (aggregator_) aggregator_(target->signature, attestation.signature);
+    } else if (aggregates.size() < limits_.aggregates_per_data) {
+        target = &aggregates.emplace_back(attestation);
+        result = Result::added;
+    } else {
+        // Replaces the smallest aggregate that it contains, or else the smallest one if it has fewer bits
+        auto smallest = std::min_element(aggregates.begin(), aggregates.end(), [&](const auto &a, const auto &b) {
+            return std::pair{!a.aggregation_bits.is_subset_of(bits), a.aggregation_bits.count()} <
+                   std::pair{!b.aggregation_bits.is_subset_of(bits), b.aggregation_bits.count()};
+        });
+        if (!smallest->aggregation_bits.is_subset_of(bits) && smallest->aggregation_bits.count() >= bits.count())
+            return Result::full;
+        *smallest = attestation;
+        target = &*smallest;
+        result = Result::added;
+    }
+
+    // Drops the aggregates that the new or merged one contains, their order does not matter
+    auto kept = std::size_t(target - aggregates.data());
+    for (auto i = aggregates.size(); i-- > 0;) {
+        if (i == kept || !aggregates[i].aggregation_bits.is_subset_of(aggregates[kept].aggregation_bits)) continue;
+        std::swap(aggregates[i], aggregates.back());
+        if (kept == aggregates.size() - 1) kept = i;
+        aggregates.pop_back();
+    }
+    return result;
+}
+
+std::vector<Attestation> AttestationPool::aggregates(const ssz::Chunk &data_root) const {
+    std::vector<Attestation> ret;
+    {
+        const auto &s = shard(data_root);
+        std::lock_guard lock{s.mutex};
+        auto entry = s.entries.find(data_root);
+        if (entry != s.entries.end()) ret = entry->second.aggregates;
+    }
+    std::stable_sort(ret.begin(), ret.end(), [](const auto &a, const auto &b) {
+        return a.aggregation_bits.count() > b.aggregation_bits.count();
+    });
+    return ret;
+}
+
+std::optional<Attestation> AttestationPool::best(const ssz::Chunk &data_root) const {
+    const auto &s = shard(data_root);
+    std::lock_guard lock{s.mutex};
+    auto entry = s.entries.find(data_root);
+    if (entry == s.entries.end() || entry->second.aggregates.empty()) return std::nullopt;
+    const auto &aggregates = entry->second.aggregates;
+    return *std::max_element(aggregates.begin(), aggregates.end(), [](const auto &a, const auto &b) {
+        return a.aggregation_bits.count() < b.aggregation_bits.count();
+    });
+}
+
+std::vector<Attestation> AttestationPool::aggregates() const {
+    std::vector<Attestation> ret;
+    for (const auto &s : shards_) {
+        std::lock_guard lock{s.mutex};
+        for (const auto &[root, entry] : s.entries)
+            ret.insert(ret.end(), entry.aggregates.begin(), entry.aggregates.end());
+    }
+    return ret;
+}
+
+void AttestationPool::prune(Slot slot) {
+    for (auto &s : shards_) {
+        std::lock_guard lock{s.mutex};
+        data_.fetch_sub(std::erase_if(s.entries, [&](const auto &entry) { return entry.second.slot < slot; }),
+                        std::memory_order_relaxed);
+    }
+}
+
+std::size_t AttestationPool::aggregate_count() const {
+    std::size_t ret = 0;
+    for (const auto &s : shards_) {
+        std::lock_guard lock{s.mutex};
+        for (const auto &[root, entry] : s.entries) ret += entry.aggregates.size();
+    }
+    return ret;
+}
+}  // namespace eth
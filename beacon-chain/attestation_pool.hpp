@@ -0,0 +1,123 @@
+/*  attestation_pool.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "beacon-chain/attestation.hpp"
+#include "ssz/ssz.hpp"
+
+namespace eth {
+/**
+ *   \brief Aggregates the attestations received from gossip, grouped by the root of their AttestationData.
+ *   \details Each data keeps up to Limits::aggregates_per_data aggregates with distinct bits. An attestation whose
+ *   bits are a subset of an aggregate is dropped, otherwise it is merged into the largest aggregate it does not
+ *   overlap, or kept as a new aggregate; aggregates that become a subset of another one are dropped. The data are
+ *   spread over shards by root, each with its own mutex, so that inserting from many threads only contends on the
+ *   same shard. Memory is bounded by Limits::data, new data are refused when it is reached until prune() removes
+ *   those of old slots.
+ *
+ *   There is no BLS library yet: merging calls the SignatureAggregator given, and without one the aggregate keeps
+ *   the signature of the first attestation it was built from.
+ */
+class AttestationPool {
+   public:
+    struct Limits {
+        std::size_t data = 1U << 14U;          // NOLINT distinct AttestationData in the pool
+        std::size_t aggregates_per_data = 16;  // NOLINT
+    };
+
+    enum class Result {
+        added,    // kept as a new aggregate
+        merged,   // merged into an existing aggregate
+        known,    // its bits are a subset of an aggregate
+        full,     // dropped, the pool or the aggregates of its data are full
+        invalid,  // no bits set or bitlists of a different size than the aggregates of its data
+    };
+
+    // Adds the signature other to aggregate
+    using SignatureAggregator = std::function<void(BLSSignature &aggregate, const BLSSignature &other)>;
+
+    AttestationPool() : AttestationPool(Limits{}) {}
+    explicit AttestationPool(Limits limits, SignatureAggregator aggregator = {})
+        : limits_{limits}, aggregator_{std::move(aggregator)} {}
+    AttestationPool(const AttestationPool &) = delete;
+    AttestationPool &operator=(const AttestationPool &) = delete;
+
+    Result insert(const Attestation &attestation) { return insert(attestation, attestation.data.hash_tree_root()); }
+    // data_root is the hash_tree_root of attestation.data, as computed when validating it
+    Result insert(const Attestation &attestation, const ssz::Chunk &data_root);
+
+    // The aggregates of the data with that root, most bits first
+    std::vector<Attestation> aggregates(const ssz::Chunk &data_root) const;
+    std::optional<Attestation> best(const ssz::Chunk &data_root) const;
+    // Every aggregate in the pool, in no particular order
+    std::vector<Attestation> aggregates() const;
+
+    // Removes the data of slots before slot
+    void prune(Slot slot);
+
+    // Number of distinct data
+    std::size_t size() const { return data_.load(std::memory_order_relaxed); }
+    std::size_t aggregate_count() const;
+
+   private:
+    static constexpr std::size_t SHARDS = 64;
+
+    // Roots are uniformly distributed, their first bytes are a good enough hash
+    struct RootHash {
+        std::size_t operator()(const ssz::Chunk &root) const noexcept {
+            std::size_t ret = 0;
+            std::memcpy(&ret, root.data(), sizeof(ret));
+            return ret;
+        }
+    };
+
+    struct Entry {
+        Slot slot;
+        std::vector<Attestation> aggregates;
+    };
+
+    struct alignas(64) Shard {  // NOLINT one per cache line
+        mutable std::mutex mutex;
+        std::unordered_map<ssz::Chunk, Entry, RootHash> entries;
+    };
+
+    Limits limits_;
+    SignatureAggregator aggregator_;
+    std::array<Shard, SHARDS> shards_;
+    std::atomic<std::size_t> data_{0};
+
+    Shard &shard(const ssz::Chunk &root) { return shards_[root.back() % SHARDS]; }
+    const Shard &shard(const ssz::Chunk &root) const { return shards_[root.back() % SHARDS]; }
+    Result insert(Entry &entry, const Attestation &attestation);
+};
+}  // namespace eth
@@ -21,98 +21,65 @@
 
 #pragma once
 
+#include <tuple>
 #include <utility>
 
 #include "beacon-chain/attestation.hpp"
 #include "beacon-chain/deposits.hpp"
 #include "beacon-chain/eth1data.hpp"
 #include "include/config.hpp"
+#include "ssz/schema.hpp"
 #include "ssz/ssz.hpp"
-#include "ssz/ssz_container.hpp"
 #include "yaml-cpp/yaml.h"
 
 namespace eth {
-struct BeaconBlockHeader : public ssz::Container {
+struct BeaconBlockHeader : public ssz::SchemaContainer<BeaconBlockHeader> {
     Slot slot;
     ValidatorIndex proposer_index;
     Root parent_root, state_root, body_root;
 
     static constexpr std::size_t ssz_size = 112;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-    std::vector<ssz::Chunk> hash_tree() const override {
-        return hash_tree_({&slot, &proposer_index, &parent_root, &state_root, &body_root});
-    }
-    BytesVector serialize() const override {
-        return serialize_({&slot, &proposer_index, &parent_root, &state_root, &body_root});
-    }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&slot, &proposer_index, &parent_root, &state_root, &body_root});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("slot", &BeaconBlockHeader::slot),
+                          ssz::field("proposer_index", &BeaconBlockHeader::proposer_index),
+                          ssz::field("parent_root", &BeaconBlockHeader::parent_root),
+                          ssz::field("state_root", &BeaconBlockHeader::state_root),
+                          ssz::field("body_root", &BeaconBlockHeader::body_root)};
     }
 
     bool operator==(const BeaconBlockHeader &) const = default;
-
-    YAML::Node encode() const override {
-        return encode_({{"slot", &slot},
-                        {"proposer_index", &proposer_index},
-                        {"parent_root", &parent_root},
-                        {"state_root", &state_root},
-                        {"body_root", &body_root}});
-    }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"slot", &slot},
-                              {"proposer_index", &proposer_index},
-                              {"parent_root", &parent_root},
-                              {"state_root", &state_root},
-                              {"body_root", &body_root}});
-    }
 };
 
-struct VoluntaryExit : public ssz::Container {
+struct VoluntaryExit : public ssz::SchemaContainer<VoluntaryExit> {
     Epoch epoch;
     ValidatorIndex validator_index;
 
     static constexpr std::size_t ssz_size = 16;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-
-    std::vector<ssz::Chunk> hash_tree() const override { return hash_tree_({&epoch, &validator_index}); }
-    BytesVector serialize() const override { return serialize_({&epoch, &validator_index}); }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&epoch, &validator_index});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("epoch", &VoluntaryExit::epoch),
+                          ssz::field("validator_index", &VoluntaryExit::validator_index)};
     }
-    bool operator==(const VoluntaryExit &) const = default;
-
-    YAML::Node encode() const override { return encode_({{"epoch", &epoch}, {"validator_index", &validator_index}}); }
 
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"epoch", &epoch}, {"validator_index", &validator_index}});
-    }
+    bool operator==(const VoluntaryExit &) const = default;
 };
 
-struct SignedVoluntaryExit : public ssz::Container {
+struct SignedVoluntaryExit : public ssz::SchemaContainer<SignedVoluntaryExit> {
     VoluntaryExit message;
     BLSSignature signature;
 
     static constexpr std::size_t ssz_size = 112;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-    std::vector<ssz::Chunk> hash_tree() const override { return hash_tree_({&message, &signature}); }
-    BytesVector serialize() const override { return serialize_({&message, &signature}); }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&message, &signature});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("message", &SignedVoluntaryExit::message),
+                          ssz::field("signature", &SignedVoluntaryExit::signature)};
     }
-    bool operator==(const SignedVoluntaryExit &) const = default;
-
-    YAML::Node encode() const override { return encode_({{"message", &message}, {"signature", &signature}}); }
 
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"message", &message}, {"signature", &signature}});
-    }
+    bool operator==(const SignedVoluntaryExit &) const = default;
 };
 
 struct ProposerSlashing;
 struct AttesterSlashing;
 
-class BeaconBlockBody : public ssz::Container {
+class BeaconBlockBody : public ssz::SchemaContainer<BeaconBlockBody> {
    private:
     BLSSignature randao_reveal_;
     Eth1Data eth1_data_;
@@ -143,46 +110,19 @@ class BeaconBlockBody : public ssz::Container {
     void deposits(ListFixedSizedParts<Deposit> &&);
     void voluntary_exits(ListFixedSizedParts<SignedVoluntaryExit> &&);
 
-    std::vector<ssz::Chunk> hash_tree() const override {
-        return hash_tree_({&randao_reveal_, &eth1_data_, &graffiti_, &proposer_slashings_, &attester_slashings_,
-                           &attestations_, &deposits_, &voluntary_exits_});
-    }
-
-    BytesVector serialize() const override {
-        return serialize_({&randao_reveal_, &eth1_data_, &graffiti_, &proposer_slashings_, &attester_slashings_,
-                           &attestations_, &deposits_, &voluntary_exits_});
-    }
-
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end,
-                            {&randao_reveal_, &eth1_data_, &graffiti_, &proposer_slashings_, &attester_slashings_,
-                             &attestations_, &deposits_, &voluntary_exits_});
-    }
-
-    YAML::Node encode() const override {
-        return encode_({{"randao_reveal", &randao_reveal_},
-                        {"eth1_data", &eth1_data_},
-                        {"graffiti", &graffiti_},
-                        {"proposer_slashings", &proposer_slashings_},
-                        {"attester_slashings", &attester_slashings_},
-                        {"attestations", &attestations_},
-                        {"deposits", &deposits_},
-                        {"voluntary_exits", &voluntary_exits_}});
-    }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"randao_reveal", &randao_reveal_},
-                              {"eth1_data", &eth1_data_},
-                              {"graffiti", &graffiti_},
-                              {"proposer_slashings", &proposer_slashings_},
-                              {"attester_slashings", &attester_slashings_},
-                              {"attestations", &attestations_},
-                              {"deposits", &deposits_},
-                              {"voluntary_exits", &voluntary_exits_}});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("randao_reveal", &BeaconBlockBody::randao_reveal_),
+                          ssz::field("eth1_data", &BeaconBlockBody::eth1_data_),
+                          ssz::field("graffiti", &BeaconBlockBody::graffiti_),
+                          ssz::field("proposer_slashings", &BeaconBlockBody::proposer_slashings_),
+                          ssz::field("attester_slashings", &BeaconBlockBody::attester_slashings_),
+                          ssz::field("attestations", &BeaconBlockBody::attestations_),
+                          ssz::field("deposits", &BeaconBlockBody::deposits_),
+                          ssz::field("voluntary_exits", &BeaconBlockBody::voluntary_exits_)};
     }
 };
 
-class BeaconBlock : public ssz::Container {
+class BeaconBlock : public ssz::SchemaContainer<BeaconBlock> {
     Slot slot_;
     ValidatorIndex proposer_index_;
     Root parent_root_, state_root_;
@@ -200,104 +140,51 @@ class BeaconBlock : public ssz::Container {
     void state_root(Root &&);
     void body(BeaconBlockBody &&);
 
-    std::vector<ssz::Chunk> hash_tree() const override {
-        return hash_tree_({&slot_, &proposer_index_, &parent_root_, &state_root_, &body_});
-    }
-
-    BytesVector serialize() const override {
-        return serialize_({&slot_, &proposer_index_, &parent_root_, &state_root_, &body_});
-    }
-
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&slot_, &proposer_index_, &parent_root_, &state_root_, &body_});
-    }
-
-    YAML::Node encode() const override {
-        return encode_({{"slot", &slot_},
-                        {"proposer_index", &proposer_index_},
-                        {"parent_root", &parent_root_},
-                        {"state_root", &state_root_},
-                        {"body", &body_}});
-    }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"slot", &slot_},
-                              {"proposer_index", &proposer_index_},
-                              {"parent_root", &parent_root_},
-                              {"state_root", &state_root_},
-                              {"body", &body_}});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("slot", &BeaconBlock::slot_),
+                          ssz::field("proposer_index", &BeaconBlock::proposer_index_),
+                          ssz::field("parent_root", &BeaconBlock::parent_root_),
+                          ssz::field("state_root", &BeaconBlock::state_root_), ssz::field("body", &BeaconBlock::body_)};
     }
 };
 
-struct SignedBeaconBlockHeader : public ssz::Container {
+struct SignedBeaconBlockHeader : public ssz::SchemaContainer<SignedBeaconBlockHeader> {
     BeaconBlockHeader message;
     BLSSignature signature;
 
     static constexpr std::size_t ssz_size = 208;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-    std::vector<ssz::Chunk> hash_tree() const override { return hash_tree_({&message, &signature}); }
-    BytesVector serialize() const override { return serialize_({&message, &signature}); }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&message, &signature});
-    }
-
-    YAML::Node encode() const override { return encode_({{"message", &message}, {"signature", &signature}}); }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"message", &message}, {"signature", &signature}});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("message", &SignedBeaconBlockHeader::message),
+                          ssz::field("signature", &SignedBeaconBlockHeader::signature)};
     }
 };
 
-struct ProposerSlashing : public ssz::Container {
+struct ProposerSlashing : public ssz::SchemaContainer<ProposerSlashing> {
     SignedBeaconBlockHeader signed_header_1, signed_header_2;
 
     static constexpr std::size_t ssz_size = 416;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-    std::vector<ssz::Chunk> hash_tree() const override { return hash_tree_({&signed_header_1, &signed_header_2}); }
-    BytesVector serialize() const override { return serialize_({&signed_header_1, &signed_header_2}); }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&signed_header_1, &signed_header_2});
-    }
-
-    YAML::Node encode() const override {
-        return encode_({{"signed_header_1", &signed_header_1}, {"signed_header_2", &signed_header_2}});
-    }
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"signed_header_1", &signed_header_1}, {"signed_header_2", &signed_header_2}});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("signed_header_1", &ProposerSlashing::signed_header_1),
+                          ssz::field("signed_header_2", &ProposerSlashing::signed_header_2)};
     }
 };
 
-struct AttesterSlashing : public ssz::Container {
+struct AttesterSlashing : public ssz::SchemaContainer<AttesterSlashing> {
     IndexedAttestation attestation_1, attestation_2;
 
-    std::vector<ssz::Chunk> hash_tree() const override { return hash_tree_({&attestation_1, &attestation_2}); }
-    BytesVector serialize() const override { return serialize_({&attestation_1, &attestation_2}); }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&attestation_1, &attestation_2});
-    }
-    YAML::Node encode() const override {
-        return encode_({{"attestation_1", &attestation_1}, {"attestation_2", &attestation_2}});
-    }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"attestation_1", &attestation_1}, {"attestation_2", &attestation_2}});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("attestation_1", &AttesterSlashing::attestation_1),
+                          ssz::field("attestation_2", &AttesterSlashing::attestation_2)};
     }
 };
 
-struct SignedBeaconBlock : public ssz::Container {
+struct SignedBeaconBlock : public ssz::SchemaContainer<SignedBeaconBlock> {
     BeaconBlock message;
     BLSSignature signature;
 
-    std::vector<ssz::Chunk> hash_tree() const override { return hash_tree_({&message, &signature}); }
-    BytesVector serialize() const override { return serialize_({&message, &signature}); }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&message, &signature});
-    }
-
-    YAML::Node encode() const override { return encode_({{"message", &message}, {"signature", &signature}}); }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"message", &message}, {"signature", &signature}});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("message", &SignedBeaconBlock::message),
+                          ssz::field("signature", &SignedBeaconBlock::signature)};
     }
 };
 }  // namespace eth
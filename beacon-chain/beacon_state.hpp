@@ -20,14 +20,17 @@
  */
 
 #pragma once
+#include <tuple>
+
 #include "beacon-chain/validator.hpp"
+#include "beacon-chain/validator_registry.hpp"
 #include "beacon_block.hpp"
 #include "common/bitlist.hpp"
 #include "common/bitvector.hpp"
-#include "ssz/ssz_container.hpp"
+#include "ssz/schema.hpp"
 
 namespace eth {
-class BeaconState : public ssz::Container {
+class BeaconState : public ssz::SchemaContainer<BeaconState> {
    private:
     UnixTime genesis_time_;
     Root genesis_validators_root_;
@@ -40,8 +43,8 @@ class BeaconState : public ssz::Container {
     ListFixedSizedParts<Eth1Data> eth1_data_votes_{constants::EPOCHS_PER_ETH1_VOTING_PERIOD *
                                                    constants::SLOTS_PER_EPOCH};
     DepositIndex eth1_deposit_index_;
-    ListFixedSizedParts<Validator> validators_{constants::VALIDATOR_REGISTRY_LIMIT};
-    ListFixedSizedParts<Gwei> balances_{constants::VALIDATOR_REGISTRY_LIMIT};
+    ValidatorRegistry validators_{constants::VALIDATOR_REGISTRY_LIMIT};
+    CachedListFixedSizedParts<Gwei> balances_{constants::VALIDATOR_REGISTRY_LIMIT};
     VectorFixedSizedParts<Bytes32, constants::EPOCHS_PER_HISTORICAL_VECTOR> randao_mixes_;
     VectorFixedSizedParts<Gwei, constants::EPOCHS_PER_SLASHINGS_VECTOR> slashings_;
     ListVariableSizedParts<PendingAttestation> previous_epoch_attestations_{constants::MAX_ATTESTATIONS *
@@ -64,6 +67,9 @@ class BeaconState : public ssz::Container {
     constexpr const auto &eth1_deposit_index() const { return eth1_deposit_index_; }
     constexpr const auto &validators() const { return validators_; }
     constexpr const auto &balances() const { return balances_; }
+    // Changes through the setters and push_back() only rehash the modified leaves on the next hash_tree_root()
+    constexpr auto &validators() { return validators_; }
+    constexpr auto &balances() { return balances_; }
     constexpr const auto &slashings() const { return slashings_; }
     constexpr const auto &randao_mixes() const { return randao_mixes_; }
     constexpr const auto &previous_epoch_attestations() const { return previous_epoch_attestations_; }
@@ -97,125 +103,32 @@ class BeaconState : public ssz::Container {
                 void finalized_checkpoint(Checkpoint);
                 */
 
-    std::vector<ssz::Chunk> hash_tree() const override {
-        return hash_tree_({&genesis_time_,
-                           &genesis_validators_root_,
-                           &slot_,
-                           &fork_,
-                           &latest_block_header_,
-                           &block_roots_,
-                           &state_roots_,
-                           &historical_roots_,
-                           &eth1_data_,
-                           &eth1_data_votes_,
-                           &eth1_deposit_index_,
-                           &validators_,
-                           &balances_,
-                           &randao_mixes_,
-                           &slashings_,
-                           &previous_epoch_attestations_,
-                           &current_epoch_attestations_,
-                           &justification_bits_,
-                           &previous_justified_checkpoint_,
-                           &current_justified_checkpoint_,
-                           &finalized_checkpoint_});
-    }
-    BytesVector serialize() const override {
-        return serialize_({&genesis_time_,
-                           &genesis_validators_root_,
-                           &slot_,
-                           &fork_,
-                           &latest_block_header_,
-                           &block_roots_,
-                           &state_roots_,
-                           &historical_roots_,
-                           &eth1_data_,
-                           &eth1_data_votes_,
-                           &eth1_deposit_index_,
-                           &validators_,
-                           &balances_,
-                           &randao_mixes_,
-                           &slashings_,
-                           &previous_epoch_attestations_,
-                           &current_epoch_attestations_,
-                           &justification_bits_,
-                           &previous_justified_checkpoint_,
-                           &current_justified_checkpoint_,
-                           &finalized_checkpoint_});
-    }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end,
-                            {&genesis_time_,
-                             &genesis_validators_root_,
-                             &slot_,
-                             &fork_,
-                             &latest_block_header_,
-                             &block_roots_,
-                             &state_roots_,
-                             &historical_roots_,
-                             &eth1_data_,
-                             &eth1_data_votes_,
-                             &eth1_deposit_index_,
-                             &validators_,
-                             &balances_,
-                             &randao_mixes_,
-                             &slashings_,
-                             &previous_epoch_attestations_,
-                             &current_epoch_attestations_,
-                             &justification_bits_,
-                             &previous_justified_checkpoint_,
-                             &current_justified_checkpoint_,
-                             &finalized_checkpoint_});
+    // The roots of the fields are computed concurrently on Container::thread_pool()
+    static constexpr bool parallel_hash_tree = true;
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("genesis_time", &BeaconState::genesis_time_),
+                          ssz::field("genesis_validators_root", &BeaconState::genesis_validators_root_),
+                          ssz::field("slot", &BeaconState::slot_),
+                          ssz::field("fork", &BeaconState::fork_),
+                          ssz::field("latest_block_header", &BeaconState::latest_block_header_),
+                          ssz::field("block_roots", &BeaconState::block_roots_),
+                          ssz::field("state_roots", &BeaconState::state_roots_),
+                          ssz::field("historical_roots", &BeaconState::historical_roots_),
+                          ssz::field("eth1_data", &BeaconState::eth1_data_),
+                          ssz::field("eth1_data_votes", &BeaconState::eth1_data_votes_),
+                          ssz::field("eth1_deposit_index", &BeaconState::eth1_deposit_index_),
+                          ssz::field("validators", &BeaconState::validators_),
+                          ssz::field("balances", &BeaconState::balances_),
+                          ssz::field("randao_mixes", &BeaconState::randao_mixes_),
+                          ssz::field("slashings", &BeaconState::slashings_),
+                          ssz::field("previous_epoch_attestations", &BeaconState::previous_epoch_attestations_),
+                          ssz::field("current_epoch_attestations", &BeaconState::current_epoch_attestations_),
+                          ssz::field("justification_bits", &BeaconState::justification_bits_),
+                          ssz::field("previous_justified_checkpoint", &BeaconState::previous_justified_checkpoint_),
+                          ssz::field("current_justified_checkpoint", &BeaconState::current_justified_checkpoint_),
+                          ssz::field("finalized_checkpoint", &BeaconState::finalized_checkpoint_)};
     }
 
     bool operator==(const BeaconState &) const = default;
-
-    YAML::Node encode() const override {
-        return encode_({{"genesis_time", &genesis_time_},
-                        {"genesis_validators_root", &genesis_validators_root_},
-                        {"slot", &slot_},
-                        {"fork", &fork_},
-                        {"latest_block_header", &latest_block_header_},
-                        {"block_roots", &block_roots_},
-                        {"state_roots", &state_roots_},
-                        {"historical_roots", &historical_roots_},
-                        {"eth1_data", &eth1_data_},
-                        {"eth1_data_votes", &eth1_data_votes_},
-                        {"eth1_deposit_index", &eth1_deposit_index_},
-                        {"validators", &validators_},
-                        {"balances", &balances_},
-                        {"randao_mixes", &randao_mixes_},
-                        {"slashings", &slashings_},
-                        {"previous_epoch_attestations", &previous_epoch_attestations_},
-                        {"current_epoch_attestations", &current_epoch_attestations_},
-                        {"justification_bits", &justification_bits_},
-                        {"previous_justified_checkpoint", &previous_justified_checkpoint_},
-                        {"current_justified_checkpoint", &current_justified_checkpoint_},
-                        {"finalized_checkpoint", &finalized_checkpoint_}});
-    }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"genesis_time", &genesis_time_},
-                              {"genesis_validators_root", &genesis_validators_root_},
-                              {"slot", &slot_},
-                              {"fork", &fork_},
-                              {"latest_block_header", &latest_block_header_},
-                              {"block_roots", &block_roots_},
-                              {"state_roots", &state_roots_},
-                              {"historical_roots", &historical_roots_},
-                              {"eth1_data", &eth1_data_},
-                              {"eth1_data_votes", &eth1_data_votes_},
-                              {"eth1_deposit_index", &eth1_deposit_index_},
-                              {"validators", &validators_},
-                              {"balances", &balances_},
-                              {"randao_mixes", &randao_mixes_},
-                              {"slashings", &slashings_},
-                              {"previous_epoch_attestations", &previous_epoch_attestations_},
-                              {"current_epoch_attestations", &current_epoch_attestations_},
-                              {"justification_bits", &justification_bits_},
-                              {"previous_justified_checkpoint", &previous_justified_checkpoint_},
-                              {"current_justified_checkpoint", &current_justified_checkpoint_},
-                              {"finalized_checkpoint", &finalized_checkpoint_}});
-    }
 };
 }  // namespace eth
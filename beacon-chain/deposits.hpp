@@ -21,85 +21,50 @@
 
 #pragma once
 #include <numeric>
+#include <tuple>
 
 #include "common/containers.hpp"
 #include "config/constants.hpp"
 #include "include/config.hpp"
-#include "ssz/ssz_container.hpp"
+#include "ssz/schema.hpp"
 #include "yaml-cpp/yaml.h"
 
 namespace eth {
-struct DepositMessage : public ssz::Container {
+struct DepositMessage : public ssz::SchemaContainer<DepositMessage> {
     BLSPubkey pubkey;
     Bytes32 withdrawal_credentials;
     Gwei amount;
 
     static constexpr std::size_t ssz_size = 88;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-    std::vector<ssz::Chunk> hash_tree() const override {
-        return hash_tree_({&pubkey, &withdrawal_credentials, &amount});
-    }
-    BytesVector serialize() const override { return serialize_({&pubkey, &withdrawal_credentials, &amount}); }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&pubkey, &withdrawal_credentials, &amount});
-    }
-    YAML::Node encode() const override {
-        return encode_({{"pubkey", &pubkey}, {"withdrawal_credentials", &withdrawal_credentials}, {"amount", &amount}});
-    }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(node,
-                       {{"pubkey", &pubkey}, {"withdrawal_credentials", &withdrawal_credentials}, {"amount", &amount}});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("pubkey", &DepositMessage::pubkey),
+                          ssz::field("withdrawal_credentials", &DepositMessage::withdrawal_credentials),
+                          ssz::field("amount", &DepositMessage::amount)};
     }
 };
 
-struct DepositData : public ssz::Container {
+struct DepositData : public ssz::SchemaContainer<DepositData> {
     BLSPubkey pubkey;
     Bytes32 withdrawal_credentials;
     Gwei amount;
     BLSSignature signature;
 
     static constexpr std::size_t ssz_size = 184;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-
-    std::vector<ssz::Chunk> hash_tree() const override {
-        return hash_tree_({&pubkey, &withdrawal_credentials, &amount, &signature});
-    }
-    BytesVector serialize() const override {
-        return serialize_({&pubkey, &withdrawal_credentials, &amount, &signature});
-    }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&pubkey, &withdrawal_credentials, &amount, &signature});
-    }
-    YAML::Node encode() const override {
-        return encode_({{"pubkey", &pubkey},
-                        {"withdrawal_credentials", &withdrawal_credentials},
-                        {"amount", &amount},
-                        {"signature", &signature}});
-    }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"pubkey", &pubkey},
-                              {"withdrawal_credentials", &withdrawal_credentials},
-                              {"amount", &amount},
-                              {"signature", &signature}});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("pubkey", &DepositData::pubkey),
+                          ssz::field("withdrawal_credentials", &DepositData::withdrawal_credentials),
+                          ssz::field("amount", &DepositData::amount),
+                          ssz::field("signature", &DepositData::signature)};
     }
 };
 
-struct Deposit : public ssz::Container {
+struct Deposit : public ssz::SchemaContainer<Deposit> {
     VectorFixedSizedParts<Bytes32, constants::DEPOSIT_CONTRACT_TREE_DEPTH + 1> proof;
     eth::DepositData data;
 
     static constexpr std::size_t ssz_size = 32 * constants::DEPOSIT_CONTRACT_TREE_DEPTH + 216;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-    std::vector<ssz::Chunk> hash_tree() const override { return hash_tree_({&proof, &data}); }
-    BytesVector serialize() const override { return serialize_({&proof, &data}); }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&proof, &data});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("proof", &Deposit::proof), ssz::field("data", &Deposit::data)};
     }
-
-    YAML::Node encode() const override { return encode_({{"proof", &proof}, {"data", &data}}); }
-
-    bool decode(const YAML::Node &node) override { return decode_(node, {{"proof", &proof}, {"data", &data}}); }
 };
 }  // namespace eth
@@ -20,32 +20,22 @@
  */
 
 #pragma once
-#include "ssz/ssz_container.hpp"
+#include <tuple>
+
+#include "ssz/schema.hpp"
 #include "yaml-cpp/yaml.h"
 
 namespace eth {
-struct Eth1Data : public ssz::Container {
+struct Eth1Data : public ssz::SchemaContainer<Eth1Data> {
     Root deposit_root;
     Counter deposit_count;
     Hash32 block_hash;
 
     static constexpr std::size_t ssz_size = 72;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-    std::vector<ssz::Chunk> hash_tree() const override {
-        return hash_tree_({&deposit_root, &deposit_count, &block_hash});
-    }
-    BytesVector serialize() const override { return serialize_({&deposit_root, &deposit_count, &block_hash}); }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&deposit_root, &deposit_count, &block_hash});
-    }
-    YAML::Node encode() const override {
-        return encode_(
-            {{"deposit_root", &deposit_root}, {"deposit_count", &deposit_count}, {"block_hash", &block_hash}});
-    }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(
-            node, {{"deposit_root", &deposit_root}, {"deposit_count", &deposit_count}, {"block_hash", &block_hash}});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("deposit_root", &Eth1Data::deposit_root),
+                          ssz::field("deposit_count", &Eth1Data::deposit_count),
+                          ssz::field("block_hash", &Eth1Data::block_hash)};
     }
 };
 }  // namespace eth
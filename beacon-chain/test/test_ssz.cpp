@@ -19,25 +19,201 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 #include "beacon-chain/attestation.hpp"
+#include "beacon-chain/attestation_packer.hpp"
+#include "beacon-chain/attestation_pool.hpp"
 #include "beacon-chain/beacon_block.hpp"
 #include "beacon-chain/beacon_state.hpp"
 #include "beacon-chain/deposits.hpp"
 #include "beacon-chain/eth1data.hpp"
 #include "beacon-chain/validator.hpp"
+#include "beacon-chain/validator_registry.hpp"
 #include "common/bitlist.hpp"
 #include "common/bitvector.hpp"
+#include "helpers/thread_pool.hpp"
 #include "include/acutest.h"
 #include "include/config.hpp"
 #include "snappy.h"
+#include "ssz/arena.hpp"
+#include "ssz/stream.hpp"
+#include "ssz/trace.hpp"
+#include "ssz/view.hpp"
 #include "yaml-cpp/yaml.h"
 
 namespace fs = std::filesystem;
 
+template <typename T>
+void test_view(const T &obj, std::span<const std::uint8_t> ssz) {
+    ssz::View<T> view{ssz};
+    auto materialized = std::make_unique<T>();
+    view.materialize(*materialized);
+    TEST_CHECK(materialized->serialize() == obj.serialize());  // NOLINT
+
+    if constexpr (std::is_same_v<T, eth::BeaconState>) {
+        TEST_CHECK(view.template get<2>().materialize() == obj.slot());  // NOLINT
+        auto validators = view.template get<11>();
+        TEST_CHECK(validators.size() == obj.validators().size());  // NOLINT
+        for (std::size_t i = 0; i < validators.size(); ++i)
+            TEST_CHECK(validators[i].materialize().serialize() == obj.validators()[i].serialize());  // NOLINT
+        TEST_CHECK(view.template get<16>().size() == obj.current_epoch_attestations().size());  // NOLINT
+        TEST_CHECK(view.template get<16>().materialize().hash_tree_root() ==                   // NOLINT
+                   obj.current_epoch_attestations().hash_tree_root());
+        auto balances = view.template get<12>().materialize();
+        TEST_CHECK(balances.hash_tree_root() == obj.balances().hash_tree_root());  // NOLINT
+    }
+    if constexpr (std::is_same_v<T, eth::SignedBeaconBlock>)
+        TEST_CHECK(view.template get<0>().template get<1>().materialize() == obj.message.proposer_index());  // NOLINT
+}
+
+void test_view_limits() {
+    // Empty lists, whose roots only depend on their limits
+    auto state = std::make_unique<eth::BeaconState>();
+    auto encoded = state->serialize();
+    ssz::View<eth::BeaconState> view{encoded};
+    TEST_CHECK(view.get<7>().materialize().hash_tree_root() == state->historical_roots().hash_tree_root());  // NOLINT
+    TEST_CHECK(view.get<9>().materialize().hash_tree_root() == state->eth1_data_votes().hash_tree_root());   // NOLINT
+    TEST_CHECK(view.get<11>().materialize().hash_tree_root() == state->validators().hash_tree_root());       // NOLINT
+    TEST_CHECK(view.get<12>().materialize().hash_tree_root() == state->balances().hash_tree_root());         // NOLINT
+    TEST_CHECK(view.get<16>().materialize().hash_tree_root() ==                                              // NOLINT
+               state->current_epoch_attestations().hash_tree_root());
+    auto materialized = std::make_unique<eth::BeaconState>();
+    view.materialize(*materialized);
+    TEST_CHECK(materialized->hash_tree_root() == state->hash_tree_root());  // NOLINT
+}
+
+void test_view_malformed() {
+    // Lengths that are not whole elements and offset tables that do not fit
+    std::vector<std::uint8_t> slots(12);  // NOLINT
+    TEST_EXCEPTION(ssz::View<eth::ListFixedSizedParts<eth::Slot>>{slots}.size(), std::invalid_argument);  // NOLINT
+    std::vector<std::uint8_t> misaligned{3, 0, 0, 0, 0}, too_long{8, 0, 0, 0}, zero{0, 0, 0, 0};  // NOLINT
+    for (const auto *bytes : {&misaligned, &too_long, &zero}) {
+        ssz::View<eth::ListVariableSizedParts<eth::Attestation>> view{*bytes};
+        TEST_EXCEPTION(view.size(), std::invalid_argument);  // NOLINT
+    }
+    std::vector<std::uint8_t> two{8, 0, 0, 0, 8, 0, 0, 0};  // NOLINT two empty attestations
+    TEST_CHECK(ssz::View<eth::ListVariableSizedParts<eth::Attestation>>{two}.size() == 2);  // NOLINT
+}
+
+void test_packed_elements() {
+    // Elements stored packed are still read and written as their own types
+    eth::ListFixedSizedParts<eth::Slot> slots{constants::MAX_VALIDATORS_PER_COMMITTEE};
+    static_assert(std::is_same_v<decltype(std::as_const(slots)[0]), eth::Slot>);
+    static_assert(std::random_access_iterator<eth::ListFixedSizedParts<eth::Slot>::const_iterator>);
+    for (std::uint64_t i = 0; i < 5; ++i) slots.push_back(eth::Slot{i});  // NOLINT
+    slots[2] = eth::Slot{7};                                              // NOLINT
+    TEST_CHECK(std::as_const(slots)[2] == eth::Slot{7});                  // NOLINT
+    std::vector<eth::Slot> copied(slots.cbegin(), slots.cend());
+    TEST_CHECK(copied == (std::vector<eth::Slot>{0, 1, 7, 3, 4}));  // NOLINT
+
+    eth::VectorFixedSizedParts<eth::Root, 4> roots;
+    eth::Root root;
+    root.data()[0] = 1;
+    roots[3] = root;
+    for (auto &&element : roots) element = root;
+    static_assert(std::is_same_v<std::iter_value_t<decltype(roots.cbegin())>, eth::Root>);
+    TEST_CHECK(std::all_of(roots.cbegin(), roots.cend(), [&root](const eth::Root &r) { return r == root; }));  // NOLINT
+
+    eth::CachedListFixedSizedParts<eth::Gwei> balances{constants::VALIDATOR_REGISTRY_LIMIT};
+    balances.push_back(eth::Gwei{32});  // NOLINT
+    static_assert(std::is_same_v<decltype(balances[0]), eth::Gwei>);
+    TEST_CHECK(balances[0] == eth::Gwei{32});  // NOLINT
+}
+
+void test_cached_lists() {
+    // Changes through the accessors of a state only rehash their leaves, the root is that of its encoding
+    auto state = std::make_unique<eth::BeaconState>();
+    for (std::uint64_t i = 0; i < 100; ++i) {  // NOLINT
+        state->validators().push_back(eth::Validator{eth::BLSPubkey{}, eth::Bytes32{}, i * 1000, false, 0, i,  // NOLINT
+                                                     constants::FAR_FUTURE_EPOCH, constants::FAR_FUTURE_EPOCH});
+        state->balances().push_back(i * 1000);  // NOLINT
+    }
+    auto before = state->hash_tree_root();
+    state->balances().set(5, 1);            // NOLINT
+    state->balances().push_back(7);         // NOLINT
+    state->validators().slashed(3, true);   // NOLINT
+    state->validators().exit_epoch(99, 7);  // NOLINT
+    state->validators().push_back(state->validators()[0]);
+    auto encoded = state->serialize();
+    auto decoded = std::make_unique<eth::BeaconState>();
+    TEST_ASSERT(decoded->deserialize(encoded.cbegin(), encoded.cend()));  // NOLINT
+    TEST_CHECK(state->hash_tree_root() != before);                        // NOLINT
+    TEST_CHECK(state->hash_tree_root() == decoded->hash_tree_root());     // NOLINT
+
+    // The caches of a const state are built by whichever thread gets there first
+    auto fresh = std::make_unique<eth::BeaconState>();
+    TEST_ASSERT(fresh->deserialize(encoded.cbegin(), encoded.cend()));  // NOLINT
+    std::vector<ssz::Chunk> roots(4);                                    // NOLINT
+    std::vector<std::thread> threads;
+    const eth::BeaconState &shared = *fresh;
+    for (auto &root : roots) threads.emplace_back([&root, &shared] { root = shared.hash_tree_root(); });
+    for (auto &thread : threads) thread.join();
+    for (const auto &root : roots) TEST_CHECK(root == decoded->hash_tree_root());  // NOLINT
+}
+
+void test_shared_pool() {
+    // Concurrent roots of a const state with one pool for the fields and the lists, whose waiting threads run the
+    // tasks of the others
+    auto state = std::make_unique<eth::BeaconState>();
+    for (std::uint64_t i = 0; i < 5000; ++i) {  // NOLINT
+        state->validators().push_back(eth::Validator{eth::BLSPubkey{}, eth::Bytes32{}, i, false, 0, i,  // NOLINT
+                                                     constants::FAR_FUTURE_EPOCH, constants::FAR_FUTURE_EPOCH});
+        state->balances().push_back(i);
+    }
+    auto encoded = state->serialize();
+    auto expected = state->hash_tree_root();
+
+    helpers::ThreadPool pool{4};  // NOLINT
+    ssz::HashTree::thread_pool(&pool);
+    ssz::Container::thread_pool(&pool);
+    for (int round = 0; round < 50; ++round) {  // NOLINT
+        auto fresh = std::make_unique<eth::BeaconState>();
+        TEST_ASSERT(fresh->deserialize(encoded.cbegin(), encoded.cend()));  // NOLINT
+        const eth::BeaconState &shared = *fresh;
+        std::vector<ssz::Chunk> roots(8);  // NOLINT
+        std::vector<std::thread> threads;
+        for (auto &root : roots) threads.emplace_back([&root, &shared] { root = shared.hash_tree_root(); });
+        for (auto &thread : threads) thread.join();
+        for (const auto &root : roots) TEST_CHECK(root == expected);  // NOLINT
+    }
+    ssz::Container::thread_pool(nullptr);
+    ssz::HashTree::thread_pool(nullptr);
+}
+
+void test_validator_registry(const eth::BeaconState &state) {
+    const auto &registry = state.validators();
+    auto registry_ssz = registry.serialize();
+    eth::ListFixedSizedParts<eth::Validator> reference{constants::VALIDATOR_REGISTRY_LIMIT};
+    TEST_CHECK(reference.deserialize(registry_ssz.begin(), registry_ssz.end()));  // NOLINT
+    TEST_CHECK(registry.hash_tree_root() == reference.hash_tree_root());        // NOLINT
+
+    eth::Epoch epoch = state.slot() / constants::SLOTS_PER_EPOCH;
+    std::vector<std::uint64_t> active, slashable;
+    std::uint64_t index = 0;
+    for (auto it = reference.cbegin(); it != reference.cend(); ++it, ++index) {
+        if (it->is_active(epoch)) active.push_back(index);
+        if (it->is_slashable(epoch)) slashable.push_back(index);
+    }
+    TEST_CHECK(registry.active_indices(epoch) == active);        // NOLINT
+    TEST_CHECK(registry.slashable_indices(epoch) == slashable);  // NOLINT
+}
+
 template <typename T>
 void test_ssz(const std::string &&path) {
     auto base_path = constants::TEST_VECTORS_PATH + path;
@@ -53,6 +229,7 @@ void test_ssz(const std::string &&path) {
                 TEST_CHECK(computed_root == root.to_array());  // NOLINT
 
                 auto serialized = ssz_type.serialize();
+                TEST_CHECK(ssz_type.serialized_size() == serialized.size());  // NOLINT
                 auto ssz_snappy_path = p2.path().string() + "/serialized.ssz_snappy";
                 std::ifstream ssz_snappy(ssz_snappy_path, std::ios::in | std::ios::binary);
                 if (not ssz_snappy.is_open())
@@ -79,6 +256,15 @@ void test_ssz(const std::string &&path) {
                 TEST_DUMP("Expected:", output.data(), serialized.size());
                 TEST_DUMP("Produced:", serialized.data(), serialized.size());
 
+                // Read in blocks smaller than most objects
+                std::istringstream in{std::string(output.begin(), output.end())};
+                ssz::StreamReader reader{in, 4096};  // NOLINT
+                T streamed;
+                TEST_CHECK(ssz::deserialize(reader, streamed) && streamed.serialize() == output);  // NOLINT
+
+                test_view(ssz_type, output);
+                if constexpr (std::is_same_v<T, eth::BeaconState>) test_validator_registry(obj);
+
                 TEST_CHECK(serialized == output);                          // NOLINT
                 TEST_MSG("Processing file: %s", ssz_snappy_path.c_str());  // NOLINT
                 TEST_DUMP("Expected:", output.data(), serialized.size());
@@ -110,6 +296,304 @@ const auto test_signedvoluntaryexit = []() { test_ssz<eth::SignedVoluntaryExit>(
 const auto test_validator = []() { test_ssz<eth::Validator>("Validator"); };
 const auto test_beaconstate = []() { test_ssz<eth::BeaconState>("BeaconState"); };
 
+void test_trace() {
+    eth::Attestation attestation;
+    std::vector<std::uint8_t> bits{0xff, 0x0f};  // NOLINT
+    attestation.aggregation_bits.deserialize(bits.cbegin(), bits.cend());
+    auto encoded = attestation.serialize();
+
+    ssz::Trace::reset();
+    ssz::Trace::start();
+    eth::Attestation decoded;
+    TEST_CHECK(decoded.deserialize(encoded.cbegin(), encoded.cend()));  // NOLINT
+    ssz::Trace::stop();
+    auto stats = ssz::Trace::snapshot();
+    if (!ssz::Trace::enabled) {
+        TEST_CHECK(stats.events == 0 && stats.types.empty());  // NOLINT
+        return;
+    }
+
+    TEST_ASSERT(stats.operations.size() == 1);  // NOLINT
+    const auto &top = stats.operations.front();
+    TEST_CHECK(top.operation == "deserialize" && top.type == "eth::Attestation" && top.calls == 1);  // NOLINT
+    auto bitlist = std::find_if(stats.types.cbegin(), stats.types.cend(),
+                                [](const auto &t) { return t.type == "eth::Bitlist"; });
+    TEST_ASSERT(bitlist != stats.types.cend());  // NOLINT
+    // The bits are the only heap allocations of the attestation
+    TEST_CHECK(bitlist->calls == 1 && bitlist->allocations > 0);  // NOLINT
+    TEST_CHECK(top.allocations == bitlist->allocations && top.self_allocations == 0);  // NOLINT
+
+    std::ostringstream json;
+    ssz::Trace::write_chrome_trace(json);
+    TEST_CHECK(json.str().find("\"name\": \"deserialize eth::Bitlist\"") != std::string::npos);  // NOLINT
+
+    // Bitvectors are traced as bitlists
+    ssz::Trace::reset();
+    ssz::Trace::start();
+    eth::Bitvector<4> justification_bits;
+    std::vector<std::uint8_t> justification{0x05};  // NOLINT
+    TEST_CHECK(justification_bits.deserialize(justification.cbegin(), justification.cend()));  // NOLINT
+    justification_bits.hash_tree_root();
+    ssz::Trace::stop();
+    stats = ssz::Trace::snapshot();
+    auto traced = [&](std::string_view operation) {
+        return std::any_of(stats.types.cbegin(), stats.types.cend(), [&](const auto &t) {
+            return t.operation == operation && t.type.find("Bitvector") != std::string::npos;
+        });
+    };
+    TEST_CHECK(traced("deserialize") && traced("hash_tree"));  // NOLINT
+    ssz::Trace::reset();
+}
+
+// Counts its allocations, which go to the heap
+class CountingResource : public std::pmr::memory_resource {
+   public:
+    std::size_t allocations = 0;
+
+   private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+};
+
+void test_arena() {
+    eth::ListVariableSizedParts<eth::Attestation> attestations{constants::MAX_ATTESTATIONS};
+    std::vector<std::uint8_t> bits{0xff, 0x0f};  // NOLINT
+    for (auto i = 0; i < 3; ++i)
+        attestations.data().emplace_back().aggregation_bits.deserialize(bits.cbegin(), bits.cend());
+    auto encoded = attestations.serialize();
+
+    CountingResource counting;
+    std::optional<eth::ListVariableSizedParts<eth::Attestation>> decoded;
+    {
+        ssz::ScopedMemoryResource scope{&counting};
+        decoded.emplace(constants::MAX_ATTESTATIONS);
+        TEST_CHECK(decoded->deserialize(encoded.cbegin(), encoded.cend()));  // NOLINT
+    }
+    // The list and the bits of each attestation
+    TEST_CHECK(counting.allocations >= 4);        // NOLINT
+    TEST_CHECK(decoded->serialize() == encoded);  // NOLINT
+    auto allocations = counting.allocations;
+    auto copy = *decoded;
+    TEST_CHECK(counting.allocations == allocations);  // NOLINT
+    TEST_CHECK(copy.serialize() == encoded);          // NOLINT
+
+    ssz::Arena arena;
+    auto in_arena = arena.deserialize<eth::ListVariableSizedParts<eth::Attestation>>(encoded.cbegin(), encoded.cend(),
+                                                                                     constants::MAX_ATTESTATIONS);
+    TEST_ASSERT(in_arena != nullptr);                                         // NOLINT
+    TEST_CHECK(in_arena->serialize() == encoded);                             // NOLINT
+    TEST_CHECK(in_arena->hash_tree_root() == attestations.hash_tree_root());  // NOLINT
+    std::vector<std::uint8_t> invalid{1, 0, 0, 0};
+    TEST_CHECK(!arena.deserialize<eth::Attestation>(invalid.cbegin(), invalid.cend()));  // NOLINT
+}
+
+eth::Attestation make_attestation(const eth::AttestationData &data, std::size_t size,
+                                  std::initializer_list<std::size_t> bits, std::uint8_t signature = 0) {
+    eth::Attestation ret;
+    ret.data = data;
+    ret.aggregation_bits.resize(size);
+    for (auto bit : bits) ret.aggregation_bits.set(bit);
+    ret.signature.data()[0] = signature;
+    return ret;
+}
+
+void test_attestation_pool() {
+    using Result = eth::AttestationPool::Result;
+    // A fake aggregation that lets us check that each merged signature is added once
+    auto xor_signatures = [](eth::BLSSignature &aggregate, const eth::BLSSignature &other) {
+        aggregate.data()[0] ^= other.to_array()[0];
+    };
+    eth::AttestationData data;
+    data.slot = 10;  // NOLINT
+    const auto root = data.hash_tree_root();
+
+    eth::AttestationPool pool{{.data = 1, .aggregates_per_data = 2}, xor_signatures};
+    TEST_CHECK(pool.insert(make_attestation(data, 8, {0}, 1)) == Result::added);      // NOLINT
+    TEST_CHECK(pool.insert(make_attestation(data, 8, {1}, 2)) == Result::merged);     // NOLINT
+    TEST_CHECK(pool.insert(make_attestation(data, 8, {0, 1}, 4)) == Result::known);   // NOLINT
+    TEST_CHECK(pool.insert(make_attestation(data, 8, {1, 2}, 4)) == Result::added);   // NOLINT
+    TEST_CHECK(pool.insert(make_attestation(data, 8, {3}, 8)) == Result::merged);     // NOLINT
+    TEST_CHECK(pool.insert(make_attestation(data, 8, {1, 4}, 8)) == Result::full);    // NOLINT
+    TEST_CHECK(pool.insert(make_attestation(data, 8, {}, 8)) == Result::invalid);     // NOLINT
+    TEST_CHECK(pool.insert(make_attestation(data, 9, {0}, 8)) == Result::invalid);    // NOLINT
+    TEST_CHECK(pool.aggregate_count() == 2);                                          // NOLINT
+
+    auto best = pool.best(root);
+    TEST_ASSERT(best.has_value());                                                      // NOLINT
+    TEST_CHECK(best->aggregation_bits == make_attestation(data, 8, {0, 1, 3}).aggregation_bits);  // NOLINT
+    TEST_CHECK(best->signature.to_array()[0] == (1 ^ 2 ^ 8));                           // NOLINT
+
+    // A superset replaces the aggregates it contains
+    TEST_CHECK(pool.insert(make_attestation(data, 8, {0, 1, 2, 3})) == Result::added);  // NOLINT
+    auto aggregates = pool.aggregates(root);
+    TEST_ASSERT(aggregates.size() == 1);             // NOLINT
+    TEST_CHECK(aggregates[0].aggregation_bits.count() == 4);  // NOLINT
+
+    // The pool holds a single data until the slot of the first one is pruned
+    auto other = data;
+    other.slot = 11;  // NOLINT
+    TEST_CHECK(pool.insert(make_attestation(other, 8, {0})) == Result::full);  // NOLINT
+    pool.prune(10);                                                             // NOLINT
+    TEST_CHECK(pool.size() == 1);                                               // NOLINT
+    pool.prune(11);                                                             // NOLINT
+    TEST_CHECK(pool.size() == 0 && !pool.best(root));                          // NOLINT
+    TEST_CHECK(pool.insert(make_attestation(other, 8, {0})) == Result::added);  // NOLINT
+
+    // Single bit attestations of several data inserted concurrently end up in one aggregate per data
+    constexpr std::size_t DATA = 16, COMMITTEE = 128, THREADS = 8;
+    std::vector<eth::AttestationData> datas(DATA);
+    for (std::size_t i = 0; i < DATA; ++i) datas[i].slot = i;
+    eth::AttestationPool concurrent{eth::AttestationPool::Limits{}, xor_signatures};
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < THREADS; ++t)
+        threads.emplace_back([&, t] {
+            for (std::size_t i = t; i < DATA * COMMITTEE; i += THREADS)
+                concurrent.insert(make_attestation(datas[i % DATA], COMMITTEE, {i / DATA}, std::uint8_t(i)));
+        });
+    for (auto &thread : threads) thread.join();
+    TEST_CHECK(concurrent.size() == DATA && concurrent.aggregate_count() == DATA);  // NOLINT
+    for (std::size_t d = 0; d < DATA; ++d) {
+        std::uint8_t signature = 0;
+        for (std::size_t i = d; i < DATA * COMMITTEE; i += DATA) signature ^= std::uint8_t(i);
+        auto aggregate = concurrent.best(datas[d].hash_tree_root());
+        TEST_ASSERT(aggregate.has_value());                                // NOLINT
+        TEST_CHECK(aggregate->aggregation_bits.count() == COMMITTEE);      // NOLINT
+        TEST_CHECK(aggregate->signature.to_array()[0] == signature);       // NOLINT
+    }
+}
+
+void test_attestation_packer() {
+    eth::AttestationData data, other;
+    data.slot = other.slot = 5;  // NOLINT
+    other.beacon_block_root.data()[0] = 1;
+    std::vector<eth::Attestation> candidates{make_attestation(data, 8, {0, 1, 2, 3}),  // NOLINT
+                                             make_attestation(data, 8, {4, 5, 6}),     // NOLINT
+                                             make_attestation(data, 8, {0, 1, 2, 3, 4, 5})};  // NOLINT
+    auto packed = [](const std::vector<eth::Attestation> &attestations) {
+        std::vector<std::size_t> ret;
+        for (const auto &attestation : attestations) ret.push_back(attestation.aggregation_bits.count());
+        return ret;
+    };
+
+    eth::AttestationPacker packer{10};  // NOLINT
+    TEST_CHECK(packed(packer.pack(candidates, 2)) == (std::vector<std::size_t>{6, 3}));  // NOLINT
+    // Votes of the same committee for other data cover the same attesters
+    candidates.push_back(make_attestation(other, 8, {6, 7}));                        // NOLINT
+    TEST_CHECK(packed(packer.pack(candidates)) == std::vector<std::size_t>{2});      // NOLINT
+    TEST_CHECK(packer.pack(candidates).empty());                                    // NOLINT
+
+    eth::AttestationPacker on_chain{10};  // NOLINT
+    on_chain.cover(data, candidates[2].aggregation_bits);
+    TEST_CHECK(packed(on_chain.pack(candidates)) == std::vector<std::size_t>{2});  // NOLINT
+
+    // Inclusion window
+    TEST_CHECK(eth::AttestationPacker{5}.pack(candidates).empty());                        // NOLINT
+    TEST_CHECK(!eth::AttestationPacker{5 + constants::SLOTS_PER_EPOCH + 1}.includable(data));  // NOLINT
+    TEST_CHECK(eth::AttestationPacker{5 + constants::SLOTS_PER_EPOCH}.includable(data));       // NOLINT
+}
+
+void test_stream() {
+    // A block body with a few of each list, the bodies have no setters
+    eth::ListVariableSizedParts<eth::Attestation> attestations{constants::MAX_ATTESTATIONS};
+    attestations.data() = {make_attestation({}, 8, {1, 2}), make_attestation({}, 100, {99})};  // NOLINT
+    std::vector<std::vector<std::uint8_t>> parts{{}, {}, attestations.serialize()};
+    parts.emplace_back(constants::MAX_DEPOSITS * eth::Deposit::ssz_size);
+    parts.emplace_back(3 * eth::SignedVoluntaryExit::ssz_size);
+    constexpr std::uint32_t fixed_length =
+        eth::BLSSignature::ssz_size + eth::Eth1Data::ssz_size + eth::Bytes32::ssz_size + 5 * 4;  // NOLINT
+    std::vector<std::uint8_t> encoded(fixed_length - 5 * 4);  // NOLINT
+    for (std::size_t i = 0; i < encoded.size(); ++i) encoded[i] = std::uint8_t(i);
+    for (std::size_t i = 0; i < parts[3].size(); ++i) parts[3][i] = std::uint8_t(i * 7);  // NOLINT
+    for (std::uint32_t offset = fixed_length; const auto &part : parts) {
+        for (std::size_t i = 0; i < 4; ++i) encoded.push_back(std::uint8_t(offset >> (8 * i)));  // NOLINT
+        offset += part.size();
+    }
+    for (const auto &part : parts) encoded.insert(encoded.end(), part.begin(), part.end());
+    eth::BeaconBlockBody body;
+    TEST_ASSERT(body.deserialize(encoded.cbegin(), encoded.cend()));  // NOLINT
+
+    auto stream = [](std::vector<std::uint8_t> encoded, std::size_t block_size) {
+        std::istringstream in{std::string(encoded.begin(), encoded.end())};
+        ssz::StreamReader reader{in, block_size, 2};
+        eth::BeaconBlockBody ret;
+        return ssz::deserialize(reader, ret) ? std::optional{ret} : std::nullopt;
+    };
+    // Fields and deposits across blocks, or several in one
+    for (std::size_t block_size : {1UL, 7UL, 100UL, 1UL << 16UL}) {  // NOLINT
+        auto streamed = stream(encoded, block_size);
+        TEST_ASSERT(streamed.has_value());                                       // NOLINT
+        TEST_CHECK(streamed->serialize() == encoded);                           // NOLINT
+        TEST_CHECK(streamed->hash_tree_root() == body.hash_tree_root());        // NOLINT
+        TEST_CHECK(streamed->deposits().size() == constants::MAX_DEPOSITS);     // NOLINT
+        TEST_CHECK(streamed->attestations().size() == attestations.size());     // NOLINT
+        TEST_MSG("block size %zu", block_size);                                 // NOLINT
+    }
+
+    // The validators, a list of fixed sized elements decoded a block at a time, straddling blocks
+    constexpr std::size_t validators = 37, slashed_offset = 48 + 32 + 8;  // NOLINT
+    std::vector<std::uint8_t> registry_ssz(validators * eth::Validator::ssz_size);
+    for (std::size_t i = 0; i < registry_ssz.size(); ++i) registry_ssz[i] = std::uint8_t(i * 13);  // NOLINT
+    for (std::size_t i = 0; i < validators; ++i) registry_ssz[i * eth::Validator::ssz_size + slashed_offset] = i % 2;
+    eth::ValidatorRegistry registry{constants::VALIDATOR_REGISTRY_LIMIT};
+    TEST_ASSERT(registry.deserialize(registry_ssz.cbegin(), registry_ssz.cend()));  // NOLINT
+    for (std::size_t block_size : {50UL, 1000UL}) {                                   // NOLINT
+        std::istringstream in{std::string(registry_ssz.begin(), registry_ssz.end())};
+        ssz::StreamReader reader{in, block_size, 2};
+        eth::ValidatorRegistry streamed{constants::VALIDATOR_REGISTRY_LIMIT};
+        TEST_CHECK(ssz::deserialize(reader, streamed));                            // NOLINT
+        TEST_CHECK(streamed.serialize() == registry_ssz);                          // NOLINT
+        TEST_CHECK(streamed.hash_tree_root() == registry.hash_tree_root());        // NOLINT
+        TEST_MSG("block size %zu", block_size);                                    // NOLINT
+    }
+
+    auto truncated = encoded, trailing = encoded, bad_offset = encoded;
+    truncated.pop_back();
+    trailing.push_back(0);
+    bad_offset[fixed_length - 4]++;  // the offset of voluntary_exits
+    TEST_CHECK(!stream(truncated, 100));   // NOLINT
+    TEST_CHECK(!stream(trailing, 100));    // NOLINT
+    TEST_CHECK(!stream(bad_offset, 100));  // NOLINT
+    TEST_CHECK(!stream({}, 100));          // NOLINT
+
+    // From a pipe written concurrently
+    std::array<int, 2> fds{};
+    TEST_ASSERT(::pipe(fds.data()) == 0);  // NOLINT
+    std::thread writer{[&] {
+        for (std::size_t i = 0; i < encoded.size(); i += 1000)  // NOLINT
+            if (::write(fds[1], encoded.data() + i, std::min<std::size_t>(1000, encoded.size() - i)) < 0) break;
+        ::close(fds[1]);
+    }};
+    eth::BeaconBlockBody from_pipe;
+    {
+        ssz::StreamReader reader{fds[0], 4096};                                          // NOLINT
+        TEST_CHECK(ssz::deserialize(reader, from_pipe) && from_pipe.serialize() == encoded);  // NOLINT
+    }
+    writer.join();
+    ::close(fds[0]);
+
+    // Giving up on a pipe whose writer stays open does not wait for its end: the first offset is wrong and only the
+    // fixed part is written
+    auto bad_first = encoded;
+    bad_first[fixed_length - 5 * 4]++;  // NOLINT
+    TEST_ASSERT(::pipe(fds.data()) == 0);                                           // NOLINT
+    TEST_ASSERT(::write(fds[1], bad_first.data(), fixed_length) == fixed_length);  // NOLINT
+    {
+        ssz::StreamReader reader{fds[0], 4096};            // NOLINT
+        TEST_CHECK(!ssz::deserialize(reader, from_pipe));  // NOLINT
+    }
+    {
+        ssz::StreamReader reader{fds[0], 4096};  // NOLINT nothing left to read, destroyed while waiting
+    }
+    ::close(fds[1]);
+    ::close(fds[0]);
+}
+
 TEST_LIST = {{"serialize_fork", test_fork},
              {"serialize_forkdata", test_forkdata},
              {"serialize_checkpoint", test_checkpoint},
@@ -133,4 +617,14 @@ TEST_LIST = {{"serialize_fork", test_fork},
              {"serialize_signedvoluntaryexit", test_signedvoluntaryexit},
              {"serialize_validator", test_validator},
              {"serialize_beaconstate", test_beaconstate},
+             {"trace", test_trace},
+             {"view_limits", test_view_limits},
+             {"view_malformed", test_view_malformed},
+             {"packed_elements", test_packed_elements},
+             {"cached_lists", test_cached_lists},
+             {"shared_pool", test_shared_pool},
+             {"arena", test_arena},
+             {"attestation_pool", test_attestation_pool},
+             {"attestation_packer", test_attestation_packer},
+             {"stream", test_stream},
              {NULL, NULL}};
@@ -20,33 +20,58 @@
  */
 
 #pragma once
+#include <tuple>
 
 #include "common/boolean.hpp"
 #include "common/slot.hpp"
 #include "config/constants.hpp"
-#include "ssz/ssz_container.hpp"
+#include "ssz/schema.hpp"
 
 namespace eth {
-class Validator : public ssz::Container {
+class Validator : public ssz::SchemaContainer<Validator> {
    private:
-    BLSPubkey pubkey;
-    Bytes32 withdrawal_credentials;
-    Gwei effective_balance;
-    Boolean slashed;
-    Epoch activation_eligibility_epoch, activation_epoch, exit_epoch, withdrawable_epoch;
+    BLSPubkey pubkey_;
+    Bytes32 withdrawal_credentials_;
+    Gwei effective_balance_;
+    Boolean slashed_;
+    Epoch activation_eligibility_epoch_, activation_epoch_, exit_epoch_, withdrawable_epoch_;
 
    public:
+    Validator() = default;
+    Validator(BLSPubkey pubkey, Bytes32 withdrawal_credentials, Gwei effective_balance, Boolean slashed,
+              Epoch activation_eligibility_epoch, Epoch activation_epoch, Epoch exit_epoch, Epoch withdrawable_epoch)
+        : pubkey_{pubkey},
+          withdrawal_credentials_{withdrawal_credentials},
+          effective_balance_{effective_balance},
+          slashed_{slashed},
+          activation_eligibility_epoch_{activation_eligibility_epoch},
+          activation_epoch_{activation_epoch},
+          exit_epoch_{exit_epoch},
+          withdrawable_epoch_{withdrawable_epoch} {}
+
+    const BLSPubkey &pubkey() const { return pubkey_; }
+    const Bytes32 &withdrawal_credentials() const { return withdrawal_credentials_; }
+    Gwei effective_balance() const { return effective_balance_; }
+    Boolean slashed() const { return slashed_; }
+    Epoch activation_eligibility_epoch() const { return activation_eligibility_epoch_; }
+    Epoch activation_epoch() const { return activation_epoch_; }
+    Epoch exit_epoch() const { return exit_epoch_; }
+    Epoch withdrawable_epoch() const { return withdrawable_epoch_; }
+
     static constexpr std::size_t ssz_size = 121;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-    std::vector<ssz::Chunk> hash_tree() const override;
-    BytesVector serialize() const override;
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override;
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("pubkey", &Validator::pubkey_),
+                          ssz::field("withdrawal_credentials", &Validator::withdrawal_credentials_),
+                          ssz::field("effective_balance", &Validator::effective_balance_),
+                          ssz::field("slashed", &Validator::slashed_),
+                          ssz::field("activation_eligibility_epoch", &Validator::activation_eligibility_epoch_),
+                          ssz::field("activation_epoch", &Validator::activation_epoch_),
+                          ssz::field("exit_epoch", &Validator::exit_epoch_),
+                          ssz::field("withdrawable_epoch", &Validator::withdrawable_epoch_)};
+    }
 
     bool is_active(const Epoch& epoch) const noexcept;
     bool is_eligible_for_activation_queue() const noexcept;
     bool is_slashable(const Epoch& epoch) const noexcept;
-
-    YAML::Node encode() const override; 
-    bool decode(const YAML::Node &node) override;
 };
 }  // namespace eth
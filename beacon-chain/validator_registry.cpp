@@ -0,0 +1,264 @@
+/*  validator_registry.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "beacon-chain/validator_registry.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+// Offsets of the fields in the SSZ encoding of a Validator
+constexpr std::size_t PUBKEY_OFFSET = 0;
+constexpr std::size_t WITHDRAWAL_CREDENTIALS_OFFSET = 48;
+constexpr std::size_t EFFECTIVE_BALANCE_OFFSET = 80;
+constexpr std::size_t SLASHED_OFFSET = 88;
+constexpr std::size_t EPOCHS_OFFSET = 89;
+
+void write_uint64(std::uint64_t value, std::uint8_t *out) {
+    std::memcpy(out, &value, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) std::reverse(out, out + sizeof(value));
+}
+
+std::uint64_t read_uint64(const std::uint8_t *in) {
+    std::uint64_t value;  // NOLINT
+    std::memcpy(&value, in, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        auto *bytes = reinterpret_cast<std::uint8_t *>(&value);  // NOLINT
+        std::reverse(bytes, bytes + sizeof(value));
+    }
+    return value;
+}
+
+ssz::Chunk uint64_chunk(std::uint64_t value) {
+    ssz::Chunk chunk{};
+    write_uint64(value, chunk.data());
+    return chunk;
+}
+}  // namespace
+
+namespace eth {
+void ValidatorRegistry::resize(std::size_t count) {
+    pubkeys_.resize(count);
+    withdrawal_credentials_.resize(count);
+    effective_balances_.resize(count);
+    slashed_.resize(count);
+    activation_eligibility_epochs_.resize(count);
+    activation_epochs_.resize(count);
+    exit_epochs_.resize(count);
+    withdrawable_epochs_.resize(count);
+}
+
+Validator ValidatorRegistry::operator[](std::size_t index) const {
+    return {BLSPubkey{pubkeys_[index]},
+            Bytes32{withdrawal_credentials_[index]},
+            effective_balances_[index],
+            bool(slashed_[index]),
+            activation_eligibility_epochs_[index],
+            activation_epochs_[index],
+            exit_epochs_[index],
+            withdrawable_epochs_[index]};
+}
+
+void ValidatorRegistry::set(std::size_t index, const Validator &validator) {
+    pubkeys_[index] = validator.pubkey().to_array();
+    withdrawal_credentials_[index] = validator.withdrawal_credentials().to_array();
+    effective_balances_[index] = validator.effective_balance();
+    slashed_[index] = validator.slashed();
+    activation_eligibility_epochs_[index] = validator.activation_eligibility_epoch();
+    activation_epochs_[index] = validator.activation_epoch();
+    exit_epochs_[index] = validator.exit_epoch();
+    withdrawable_epochs_[index] = validator.withdrawable_epoch();
+    cache_.changed(index);
+}
+
+void ValidatorRegistry::push_back(const Validator &validator) {
+    resize(size() + 1);
+    set(size() - 1, validator);
+}
+
+void ValidatorRegistry::effective_balance(std::size_t index, Gwei balance) {
+    effective_balances_[index] = balance;
+    cache_.changed(index);
+}
+void ValidatorRegistry::slashed(std::size_t index, bool slashed) {
+    slashed_[index] = slashed;
+    cache_.changed(index);
+}
+void ValidatorRegistry::activation_eligibility_epoch(std::size_t index, Epoch epoch) {
+    activation_eligibility_epochs_[index] = epoch;
+    cache_.changed(index);
+}
+void ValidatorRegistry::activation_epoch(std::size_t index, Epoch epoch) {
+    activation_epochs_[index] = epoch;
+    cache_.changed(index);
+}
+void ValidatorRegistry::exit_epoch(std::size_t index, Epoch epoch) {
+    exit_epochs_[index] = epoch;
+    cache_.changed(index);
+}
+void ValidatorRegistry::withdrawable_epoch(std::size_t index, Epoch epoch) {
+    withdrawable_epochs_[index] = epoch;
+    cache_.changed(index);
+}
+
+std::vector<std::uint64_t> ValidatorRegistry::active_indices(Epoch epoch) const {
+    return indices_where([this, epoch](std::size_t i) { return is_active(i, epoch); });
+}
+
+std::vector<std::uint64_t> ValidatorRegistry::slashable_indices(Epoch epoch) const {
+    return indices_where([this, epoch](std::size_t i) { return is_slashable(i, epoch); });
+}
+
+std::vector<std::uint64_t> ValidatorRegistry::eligible_for_activation_queue_indices() const {
+    return indices_where([this](std::size_t i) { return is_eligible_for_activation_queue(i); });
+}
+
+Gwei ValidatorRegistry::total_active_balance(Epoch epoch) const {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < size(); ++i) total += is_active(i, epoch) ? effective_balances_[i] : 0;
+    return std::max(total, std::uint64_t(constants::EFFECTIVE_BALANCE_INCREMENT));
+}
+
+// The pubkey roots and then the validator roots are hashed for all the validators at once, so that the hasher gets
+// full batches
+template <class Index>
+void ValidatorRegistry::hash_leaves(std::size_t count, Index index, ssz::Chunk *out) const {
+    constexpr std::size_t FIELDS = 8;
+    constexpr std::size_t PUBKEY_CHUNKS = 2;
+    std::vector<ssz::Chunk> pubkey_chunks(PUBKEY_CHUNKS * count);
+    std::vector<ssz::Chunk> fields(FIELDS * count);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto v = index(i);
+        std::memcpy(pubkey_chunks[PUBKEY_CHUNKS * i].data(), pubkeys_[v].data(), pubkeys_[v].size());
+        // The pubkey roots are filled in by merkleize_many, a boolean has the same chunk as an integer
+        std::array<ssz::Chunk, FIELDS> leaves{ssz::Chunk{},
+                                              withdrawal_credentials_[v],
+                                              uint64_chunk(effective_balances_[v]),
+                                              uint64_chunk(slashed_[v]),
+                                              uint64_chunk(activation_eligibility_epochs_[v]),
+                                              uint64_chunk(activation_epochs_[v]),
+                                              uint64_chunk(exit_epochs_[v]),
+                                              uint64_chunk(withdrawable_epochs_[v])};
+        std::copy(leaves.cbegin(), leaves.cend(), fields.begin() + FIELDS * i);
+    }
+    ssz::merkleize_many(pubkey_chunks.data(), count, PUBKEY_CHUNKS, fields.data(), FIELDS);
+    ssz::merkleize_many(fields.data(), count, FIELDS, out);
+}
+
+std::vector<ssz::Chunk> ValidatorRegistry::hash_tree() const {
+    auto all_leaves = [this] {
+        std::vector<ssz::Chunk> leaves(size());
+        auto compute_leaves = [&](std::size_t block) {
+            auto first = block * LEAVES_PER_TASK;
+            auto last = std::min(first + LEAVES_PER_TASK, leaves.size());
+            hash_leaves(last - first, [first](std::size_t i) { return first + i; }, leaves.data() + first);
+        };
+        auto blocks = (leaves.size() + LEAVES_PER_TASK - 1) / LEAVES_PER_TASK;
+        if (auto *pool = ssz::HashTree::thread_pool())
+            pool->parallel_for(blocks, compute_leaves);
+        else
+            for (std::size_t block = 0; block < blocks; ++block) compute_leaves(block);
+        return leaves;
+    };
+    auto changed_leaves = [this](const std::vector<std::size_t> &indices) {
+        std::vector<ssz::Chunk> leaves(indices.size());
+        hash_leaves(indices.size(), [&indices](std::size_t i) { return indices[i]; }, leaves.data());
+        return leaves;
+    };
+    return {cache_.hash_tree_root(size(), size(), 1, all_leaves, changed_leaves)};
+}
+
+std::size_t ValidatorRegistry::serialize_into(std::span<std::uint8_t> out) const {
+    SSZ_TRACE_SCOPE("serialize_into");
+    if (out.size() < serialized_size()) throw std::out_of_range("buffer too small for SSZ encoding");
+    auto *it = out.data();
+    for (std::size_t i = 0; i < size(); ++i, it += Validator::ssz_size) {
+        std::copy(pubkeys_[i].cbegin(), pubkeys_[i].cend(), it + PUBKEY_OFFSET);
+        std::copy(withdrawal_credentials_[i].cbegin(), withdrawal_credentials_[i].cend(),
+                  it + WITHDRAWAL_CREDENTIALS_OFFSET);
+        write_uint64(effective_balances_[i], it + EFFECTIVE_BALANCE_OFFSET);
+        it[SLASHED_OFFSET] = slashed_[i];
+        write_uint64(activation_eligibility_epochs_[i], it + EPOCHS_OFFSET);
+        write_uint64(activation_epochs_[i], it + EPOCHS_OFFSET + sizeof(std::uint64_t));
+        write_uint64(exit_epochs_[i], it + EPOCHS_OFFSET + 2 * sizeof(std::uint64_t));
+        write_uint64(withdrawable_epochs_[i], it + EPOCHS_OFFSET + 3 * sizeof(std::uint64_t));
+    }
+    return serialized_size();
+}
+
+void ValidatorRegistry::reserve(std::size_t count) {
+    pubkeys_.reserve(count);
+    withdrawal_credentials_.reserve(count);
+    effective_balances_.reserve(count);
+    slashed_.reserve(count);
+    activation_eligibility_epochs_.reserve(count);
+    activation_epochs_.reserve(count);
+    exit_epochs_.reserve(count);
+    withdrawable_epochs_.reserve(count);
+}
+
+bool ValidatorRegistry::deserialize(ssz::SSZIterator it, ssz::SSZIterator end) {
+    SSZ_TRACE_SCOPE("deserialize");
+    resize(0);
+    return deserialize_append(it, end);
+}
+
+bool ValidatorRegistry::deserialize_append(ssz::SSZIterator it, ssz::SSZIterator end) {
+    cache_.invalidate();
+    if (std::distance(it, end) % Validator::ssz_size) return false;
+    const auto first = size();
+    resize(first + std::distance(it, end) / Validator::ssz_size);
+
+    for (std::size_t i = first; i < size(); ++i, it += Validator::ssz_size) {
+        const auto *in = &*it;
+        std::copy(in + PUBKEY_OFFSET, in + WITHDRAWAL_CREDENTIALS_OFFSET, pubkeys_[i].begin());
+        std::copy(in + WITHDRAWAL_CREDENTIALS_OFFSET, in + EFFECTIVE_BALANCE_OFFSET,
+                  withdrawal_credentials_[i].begin());
+        effective_balances_[i] = read_uint64(in + EFFECTIVE_BALANCE_OFFSET);
+        if (in[SLASHED_OFFSET] > 1) return false;
+        slashed_[i] = in[SLASHED_OFFSET];
+        activation_eligibility_epochs_[i] = read_uint64(in + EPOCHS_OFFSET);
+        activation_epochs_[i] = read_uint64(in + EPOCHS_OFFSET + sizeof(std::uint64_t));
+        exit_epochs_[i] = read_uint64(in + EPOCHS_OFFSET + 2 * sizeof(std::uint64_t));
+        withdrawable_epochs_[i] = read_uint64(in + EPOCHS_OFFSET + 3 * sizeof(std::uint64_t));
+    }
+    return true;
+}
+
+YAML::Node ValidatorRegistry::encode() const {
+    std::vector<Validator> validators;
+    validators.reserve(size());
+    for (std::size_t i = 0; i < size(); ++i) validators.push_back((*this)[i]);
+    return YAML::convert<std::vector<Validator>>::encode(validators);
+}
+
+bool ValidatorRegistry::decode(const YAML::Node &node) {
+    std::vector<Validator> validators;
+    if (!YAML::convert<std::vector<Validator>>::decode(node, validators)) return false;
+    cache_.invalidate();
+    resize(0);
+    for (const auto &validator : validators) push_back(validator);
+    return true;
+}
+}  // namespace eth
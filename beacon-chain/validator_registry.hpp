@@ -0,0 +1,135 @@
+/*  validator_registry.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "beacon-chain/validator.hpp"
+#include "common/containers.hpp"
+#include "ssz/arena.hpp"
+#include "ssz/hashtree.hpp"
+#include "ssz/ssz_container.hpp"
+
+namespace eth {
+/**
+ *   \brief The validator registry, stored by columns.
+ *   \details It serializes and merkleizes as List[Validator] but keeps each field of the validators in its own
+ *   array, so that scans over the registry only read the fields they need and can be vectorized. Columns are read
+ *   only, modifications go through the setters so that the cached Merkle tree is updated as in
+ *   CachedListFixedSizedParts. As for that list, the root of a const registry can be computed from several threads.
+ */
+class ValidatorRegistry : public ssz::Container {
+   private:
+    ssz::vector<packed_t<BLSPubkey>> pubkeys_;
+    ssz::vector<packed_t<Bytes32>> withdrawal_credentials_;
+    ssz::vector<std::uint64_t> effective_balances_;
+    ssz::vector<std::uint8_t> slashed_;
+    ssz::vector<std::uint64_t> activation_eligibility_epochs_, activation_epochs_, exit_epochs_,
+        withdrawable_epochs_;
+    std::size_t limit_;
+
+    ssz::ListTreeCache cache_;
+
+    // Leaves are computed in blocks of this size, concurrently when HashTree has a thread pool
+    static constexpr std::size_t LEAVES_PER_TASK = 256;
+
+    // Computes the leaves of count validators, index(i) is the position in the registry of the i-th one
+    template <class Index>
+    void hash_leaves(std::size_t count, Index index, ssz::Chunk *out) const;
+    void resize(std::size_t count);
+
+    // Indices for which pred is true, the predicate is first evaluated over the whole registry into a mask
+    template <class Pred>
+    std::vector<std::uint64_t> indices_where(Pred pred) const {
+        std::vector<std::uint8_t> mask(size());
+        for (std::size_t i = 0; i < mask.size(); ++i) mask[i] = pred(i);
+        std::vector<std::uint64_t> ret;
+        for (std::size_t i = 0; i < mask.size(); ++i)
+            if (mask[i]) ret.push_back(i);
+        return ret;
+    }
+
+   protected:
+    std::vector<ssz::Chunk> hash_tree() const override;
+
+   public:
+    using value_type = Validator;
+
+    explicit ValidatorRegistry(std::size_t limit = 0) : limit_{limit}, cache_{limit} {}
+
+    std::size_t size() const { return effective_balances_.size(); }
+    std::size_t limit() const { return limit_; }
+    void limit(std::size_t limit) {
+        limit_ = limit;
+        cache_.limit(limit);
+    }
+
+    Validator operator[](std::size_t index) const;
+    void set(std::size_t index, const Validator &validator);
+    void push_back(const Validator &validator);
+
+    std::span<const packed_t<BLSPubkey>> pubkeys() const { return pubkeys_; }
+    std::span<const packed_t<Bytes32>> withdrawal_credentials() const { return withdrawal_credentials_; }
+    std::span<const std::uint64_t> effective_balances() const { return effective_balances_; }
+    std::span<const std::uint8_t> slashed() const { return slashed_; }
+    std::span<const std::uint64_t> activation_eligibility_epochs() const { return activation_eligibility_epochs_; }
+    std::span<const std::uint64_t> activation_epochs() const { return activation_epochs_; }
+    std::span<const std::uint64_t> exit_epochs() const { return exit_epochs_; }
+    std::span<const std::uint64_t> withdrawable_epochs() const { return withdrawable_epochs_; }
+
+    void effective_balance(std::size_t index, Gwei balance);
+    void slashed(std::size_t index, bool slashed);
+    void activation_eligibility_epoch(std::size_t index, Epoch epoch);
+    void activation_epoch(std::size_t index, Epoch epoch);
+    void exit_epoch(std::size_t index, Epoch epoch);
+    void withdrawable_epoch(std::size_t index, Epoch epoch);
+
+    bool is_active(std::size_t index, Epoch epoch) const noexcept {
+        return activation_epochs_[index] <= epoch && epoch < exit_epochs_[index];
+    }
+    bool is_eligible_for_activation_queue(std::size_t index) const noexcept {
+        return activation_eligibility_epochs_[index] == std::uint64_t(constants::FAR_FUTURE_EPOCH) &&
+               effective_balances_[index] == std::uint64_t(constants::MAX_EFFECTIVE_BALANCE);
+    }
+    bool is_slashable(std::size_t index, Epoch epoch) const noexcept {
+        return !slashed_[index] && activation_epochs_[index] <= epoch && epoch < withdrawable_epochs_[index];
+    }
+
+    std::vector<std::uint64_t> active_indices(Epoch epoch) const;
+    std::vector<std::uint64_t> slashable_indices(Epoch epoch) const;
+    std::vector<std::uint64_t> eligible_for_activation_queue_indices() const;
+    // Sum of the effective balances of the active validators, at least EFFECTIVE_BALANCE_INCREMENT
+    Gwei total_active_balance(Epoch epoch) const;
+
+    std::size_t serialized_size() const override { return size() * Validator::ssz_size; }
+    std::size_t serialize_into(std::span<std::uint8_t> out) const override;
+    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override;
+    // Decodes the validators in [it, end) after the current ones, to decode the registry a piece at a time
+    void reserve(std::size_t count);
+    bool deserialize_append(ssz::SSZIterator it, ssz::SSZIterator end);
+
+    YAML::Node encode() const override;
+    bool decode(const YAML::Node &node) override;
+};
+}  // namespace eth
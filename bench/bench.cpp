@@ -0,0 +1,111 @@
+/*  bench.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench/bench.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+namespace {
+constexpr int NAME_WIDTH = 48;
+constexpr int COLUMN_WIDTH = 13;
+
+// Times with three significant digits and the largest unit in which they are at least one
+std::string format_time(double ns) {
+    constexpr std::array<const char *, 4> units{"ns", "us", "ms", "s"};
+    std::size_t unit = 0;
+    for (; unit + 1 < units.size() && ns >= 1000; ++unit) ns /= 1000;  // NOLINT
+    std::ostringstream os;
+    os << std::setprecision(3) << ns << ' ' << units[unit];
+    return os.str();
+}
+
+std::string format_rate(double rate) {
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(rate < 100 ? 2 : 0) << rate;  // NOLINT
+    return os.str();
+}
+}  // namespace
+
+namespace bench {
+Suite::Suite(Options options, std::ostream &out) : options_{std::move(options)}, out_{out} {
+    out_ << std::left << std::setw(NAME_WIDTH) << "Benchmark" << std::right;
+    for (const auto *column : {"Median", "p99", "Stddev", "MB/s", "Hashes/s"})
+        out_ << std::setw(COLUMN_WIDTH) << column;
+    out_ << '\n' << std::string(NAME_WIDTH + 5 * COLUMN_WIDTH, '-') << std::endl;
+}
+
+bool Suite::enabled(std::string_view name) const { return name.find(options_.filter) != std::string_view::npos; }
+
+std::size_t Suite::iterations(clock::duration first) const {
+    auto first_ns = std::max(1.0, std::chrono::duration<double, std::nano>(first).count());
+    return std::max<std::size_t>(1, std::size_t(options_.min_time * 1e9 / first_ns));  // NOLINT
+}
+
+void Suite::record(std::string name, std::size_t bytes, std::size_t hashes, std::size_t iterations,
+                   std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    const auto n = samples.size();
+    Result result;
+    result.name = std::move(name);
+    result.iterations = iterations;
+    result.repetitions = n;
+    result.bytes = bytes;
+    result.hashes = hashes;
+    result.median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    // Nearest rank
+    result.p99 = samples[std::size_t(std::ceil(0.99 * double(n))) - 1];  // NOLINT
+    result.mean = std::accumulate(samples.cbegin(), samples.cend(), 0.0) / double(n);
+    double squares = 0;
+    for (auto sample : samples) squares += (sample - result.mean) * (sample - result.mean);
+    result.stddev = n > 1 ? std::sqrt(squares / double(n - 1)) : 0;
+
+    out_ << std::left << std::setw(NAME_WIDTH) << result.name << std::right;
+    out_ << std::setw(COLUMN_WIDTH) << format_time(result.median) << std::setw(COLUMN_WIDTH)
+         << format_time(result.p99) << std::setw(COLUMN_WIDTH) << format_time(result.stddev);
+    out_ << std::setw(COLUMN_WIDTH) << (bytes ? format_rate(result.mb_per_second()) : "-");
+    out_ << std::setw(COLUMN_WIDTH) << (hashes ? format_rate(result.hashes_per_second()) : "-") << std::endl;
+    results_.push_back(std::move(result));
+}
+
+void Suite::write_json(std::ostream &os, const std::vector<std::pair<std::string, std::string>> &context) const {
+    os << "{\n  \"context\": {";
+    for (std::size_t i = 0; i < context.size(); ++i)
+        os << (i ? ",\n" : "\n") << "    " << std::quoted(context[i].first) << ": "
+           << std::quoted(context[i].second);
+    os << "\n  },\n  \"benchmarks\": [";
+    os << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (std::size_t i = 0; i < results_.size(); ++i) {
+        const auto &r = results_[i];
+        os << (i ? ",\n" : "\n") << "    {\"name\": " << std::quoted(r.name) << ", \"iterations\": " << r.iterations
+           << ", \"repetitions\": " << r.repetitions << ", \"median_ns\": " << r.median << ", \"p99_ns\": " << r.p99
+           << ", \"mean_ns\": " << r.mean << ", \"stddev_ns\": " << r.stddev << ", \"bytes\": " << r.bytes
+           << ", \"mb_per_second\": " << (r.bytes ? r.mb_per_second() : 0) << ", \"hashes\": " << r.hashes
+           << ", \"hashes_per_second\": " << (r.hashes ? r.hashes_per_second() : 0) << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+}  // namespace bench
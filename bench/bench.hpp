@@ -0,0 +1,119 @@
+/*  bench.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bench {
+// Keeps the compiler from discarding a value that is only computed to be timed
+template <class T>
+inline void do_not_optimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Options {
+    std::size_t repetitions = 20;  // NOLINT
+    double min_time = 0.05;        // NOLINT seconds that each repetition runs at least
+    std::string filter;            // only benchmarks whose name contains it are run
+};
+
+// Statistics of the time per operation over the repetitions, in nanoseconds
+struct Result {
+    std::string name;
+    std::size_t iterations = 0, repetitions = 0;
+    std::size_t bytes = 0, hashes = 0;  // processed per operation, hashes are 64 bytes blocks
+    double median = 0, p99 = 0, mean = 0, stddev = 0;
+
+    double mb_per_second() const { return double(bytes) * 1e3 / median; }         // NOLINT
+    double hashes_per_second() const { return double(hashes) * 1e9 / median; }  // NOLINT
+};
+
+/**
+ *   \brief Runs benchmarks and collects their results.
+ *   \details Each benchmark is timed for Options::repetitions samples, a sample runs the operation as many times as
+ *   fit in Options::min_time, calibrated on a first untimed run. Results are printed as they complete and can be
+ *   written as JSON at the end.
+ */
+class Suite {
+   private:
+    using clock = std::chrono::steady_clock;
+
+    Options options_;
+    std::ostream &out_;
+    std::vector<Result> results_;
+
+    std::size_t iterations(clock::duration first) const;
+    void record(std::string name, std::size_t bytes, std::size_t hashes, std::size_t iterations,
+                std::vector<double> samples);
+
+   public:
+    Suite(Options options, std::ostream &out);
+
+    const Options &options() const { return options_; }
+    const std::vector<Result> &results() const { return results_; }
+    bool enabled(std::string_view name) const;
+
+    // Times op(), that processes bytes and hashes blocks each time it is called
+    template <class Op>
+    void run(std::string name, std::size_t bytes, std::size_t hashes, Op op) {
+        if (!enabled(name)) return;
+        auto start = clock::now();
+        op();
+        auto count = iterations(clock::now() - start);
+        std::vector<double> samples;
+        for (std::size_t r = 0; r < options_.repetitions; ++r) {
+            start = clock::now();
+            for (std::size_t i = 0; i < count; ++i) op();
+            samples.push_back(std::chrono::duration<double, std::nano>(clock::now() - start).count() / count);
+        }
+        record(std::move(name), bytes, hashes, count, std::move(samples));
+    }
+
+    // Times op(setup()), the objects returned by setup are built before each sample and are not timed
+    template <class Setup, class Op>
+    void run(std::string name, std::size_t bytes, std::size_t hashes, Setup setup, Op op) {
+        if (!enabled(name)) return;
+        auto input = setup();
+        auto start = clock::now();
+        op(input);
+        auto count = iterations(clock::now() - start);
+        std::vector<double> samples;
+        for (std::size_t r = 0; r < options_.repetitions; ++r) {
+            std::vector<decltype(setup())> inputs;
+            inputs.reserve(count);
+            for (std::size_t i = 0; i < count; ++i) inputs.push_back(setup());
+            start = clock::now();
+            for (auto &in : inputs) op(in);
+            samples.push_back(std::chrono::duration<double, std::nano>(clock::now() - start).count() / count);
+        }
+        record(std::move(name), bytes, hashes, count, std::move(samples));
+    }
+
+    // context is written as string pairs before the results
+    void write_json(std::ostream &os, const std::vector<std::pair<std::string, std::string>> &context) const;
+};
+}  // namespace bench
@@ -0,0 +1,275 @@
+/*  bench_attestations.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Times the attestation pool on the gossip of a slot as in mainnet: an unaggregated attestation of each member
+ *  of every committee followed by the aggregates of the aggregators of each committee, inserted from several
+ *  threads into an empty pool. Then times packing a block from the aggregates of a whole epoch, with the lazy
+ *  greedy packer and with the plain greedy algorithm that recomputes every gain on each choice.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "beacon-chain/attestation.hpp"
+#include "beacon-chain/attestation_packer.hpp"
+#include "beacon-chain/attestation_pool.hpp"
+#include "bench/bench.hpp"
+#include "bench/synthetic.hpp"
+#include "helpers/thread_pool.hpp"
+
+namespace {
+constexpr std::size_t AGGREGATORS_PER_COMMITTEE = 16;  // TARGET_AGGREGATORS_PER_COMMITTEE
+constexpr double PARTICIPATION = 0.9;
+
+struct Config {
+    bench::Options options;
+    std::vector<std::size_t> validators{500000, 1000000};  // NOLINT
+    std::vector<std::size_t> threads{1, 4};                // NOLINT
+    std::size_t aggregates = 50000;                        // NOLINT
+    std::uint64_t seed = 0;
+    std::string json;
+};
+
+void usage(const char *name) {
+    std::cout << "Usage: " << name << " [options]\n"
+              << "  --validators N[,N...]  validator counts (500000,1000000)\n"
+              << "  --threads N[,N...]     threads inserting into the pool (1,4)\n"
+              << "  --aggregates N         candidates to pack a block from (50000)\n"
+              << "  --repetitions N        samples of each benchmark (20)\n"
+              << "  --min-time S           seconds that each sample runs at least (0.05)\n"
+              << "  --filter STR           only run the benchmarks whose name contains STR\n"
+              << "  --seed N               seed of the synthetic attestations (0)\n"
+              << "  --json PATH            write the results as JSON to PATH\n";
+}
+
+std::vector<std::size_t> parse_list(std::string_view str) {
+    std::vector<std::size_t> ret;
+    while (!str.empty()) {
+        auto comma = std::min(str.find(','), str.size());
+        ret.push_back(std::stoull(std::string(str.substr(0, comma))));
+        str.remove_prefix(std::min(comma + 1, str.size()));
+    }
+    return ret;
+}
+
+std::optional<Config> parse(int argc, const char *argv[]) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg{argv[i]};  // NOLINT
+        if (i + 1 == argc) return std::nullopt;
+        std::string value{argv[++i]};  // NOLINT
+        if (arg == "--validators")
+            config.validators = parse_list(value);
+        else if (arg == "--threads")
+            config.threads = parse_list(value);
+        else if (arg == "--aggregates")
+            config.aggregates = std::stoull(value);
+        else if (arg == "--repetitions")
+            config.options.repetitions = std::max<std::size_t>(1, std::stoull(value));
+        else if (arg == "--min-time")
+            config.options.min_time = std::stod(value);
+        else if (arg == "--filter")
+            config.options.filter = value;
+        else if (arg == "--seed")
+            config.seed = std::stoull(value);
+        else if (arg == "--json")
+            config.json = value;
+        else
+            return std::nullopt;
+    }
+    if (std::find(config.threads.begin(), config.threads.end(), 0) != config.threads.end()) return std::nullopt;
+    return config;
+}
+
+// The attestations of a slot with the roots of their data, as computed by gossip validation
+struct Gossip {
+    std::vector<eth::Attestation> attestations;
+    std::vector<ssz::Chunk> roots;
+    std::size_t bytes = 0;
+};
+
+Gossip slot_gossip(std::size_t validators, std::uint64_t seed) {
+    const auto committees = std::clamp<std::size_t>(
+        validators / (constants::SLOTS_PER_EPOCH * constants::TARGET_COMMITTEE_SIZE), 1,
+        constants::MAX_COMMITTEES_PER_SLOT);
+    const auto committee_size = bench::committee_size(validators);
+    bench::Generator gen{{.committee_size = committee_size, .participation = PARTICIPATION}, seed};
+
+    std::vector<eth::AttestationData> data(committees);
+    for (std::size_t c = 0; c < committees; ++c) {
+        gen.fill(data[c]);
+        data[c].index = c;
+    }
+    Gossip ret;
+    for (std::size_t c = 0; c < committees; ++c)
+        for (std::size_t member = 0; member < committee_size; ++member) {
+            auto &attestation = ret.attestations.emplace_back();
+            attestation.data = data[c];
+            attestation.aggregation_bits.resize(committee_size);
+            attestation.aggregation_bits.set(member);
+            gen.fill(attestation.signature);
+        }
+    // Unaggregated attestations arrive in any order, the aggregates at a third of the slot
+    for (std::size_t i = ret.attestations.size(); i > 1; --i)
+        std::swap(ret.attestations[i - 1], ret.attestations[gen.word() % i]);
+    for (std::size_t c = 0; c < committees; ++c)
+        for (std::size_t a = 0; a < AGGREGATORS_PER_COMMITTEE; ++a) {
+            auto &attestation = ret.attestations.emplace_back();
+            attestation.data = data[c];
+            gen.fill(attestation.aggregation_bits, committee_size);
+            gen.fill(attestation.signature);
+        }
+    for (const auto &attestation : ret.attestations) {
+        ret.roots.push_back(attestation.data.hash_tree_root());
+        ret.bytes += attestation.serialized_size();
+    }
+    return ret;
+}
+
+void bench_pool(bench::Suite &suite, std::size_t validators, std::size_t threads, std::uint64_t seed) {
+    const auto name = "AttestationPool/insert_slot/" + std::to_string(validators) + "/threads:" + std::to_string(threads);
+    if (!suite.enabled(name)) return;
+    const auto gossip = slot_gossip(validators, seed);
+    const auto count = gossip.attestations.size();
+
+    helpers::ThreadPool pool{threads - 1};
+    suite.run(
+        name, gossip.bytes, 0, [] { return std::make_unique<eth::AttestationPool>(); },
+        [&](auto &attestations) {
+            pool.parallel_for(threads, [&](std::size_t t) {
+                for (std::size_t i = t; i < count; i += threads)
+                    attestations->insert(gossip.attestations[i], gossip.roots[i]);
+            });
+        });
+
+    const auto per_second = double(count) * 1e9 / suite.results().back().median;  // NOLINT
+    std::cout << "    " << count << " attestations, " << std::fixed << std::setprecision(0) << per_second
+              << " per second, an epoch in " << std::setprecision(1)
+              << double(count * constants::SLOTS_PER_EPOCH) * 1e3 / per_second << " ms\n";  // NOLINT
+    std::cout.unsetf(std::ios::fixed);
+}
+
+// Aggregates spread over the committees of an epoch, packed into the block of the slot after it
+std::vector<eth::Attestation> epoch_aggregates(std::size_t validators, std::size_t count, std::uint64_t seed) {
+    const auto committees = std::clamp<std::size_t>(
+        validators / (constants::SLOTS_PER_EPOCH * constants::TARGET_COMMITTEE_SIZE), 1,
+        constants::MAX_COMMITTEES_PER_SLOT);
+    bench::Generator gen{{.committee_size = bench::committee_size(validators), .participation = 0.2}, seed};  // NOLINT
+    std::vector<eth::AttestationData> data(constants::SLOTS_PER_EPOCH * committees);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        gen.fill(data[i]);
+        data[i].slot = 1 + i / committees;
+        data[i].index = i % committees;
+    }
+    std::vector<eth::Attestation> ret(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        ret[i].data = data[i % data.size()];
+        gen.fill(ret[i].aggregation_bits, gen.shape().committee_size);
+    }
+    return ret;
+}
+
+// The greedy choice recomputing the gain of every candidate, as the lazy packer but without skipping any
+std::vector<eth::Attestation> greedy(std::span<const eth::Attestation> candidates, std::size_t max) {
+    std::map<std::pair<std::uint64_t, std::uint64_t>, eth::Bitlist> covered;
+    std::vector<eth::Bitlist *> committees;
+    for (const auto &candidate : candidates) {
+        auto [it, inserted] = covered.try_emplace({candidate.data.slot, candidate.data.index},
+                                                  constants::MAX_VALIDATORS_PER_COMMITTEE);
+        if (inserted) it->second.resize(candidate.aggregation_bits.size());
+        committees.push_back(&it->second);
+    }
+    std::vector<eth::Attestation> ret;
+    while (ret.size() < max) {
+        std::size_t best = 0, best_gain = 0;
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            auto gain = candidates[i].aggregation_bits.count_not_in(*committees[i]);
+            if (gain > best_gain) {
+                best = i;
+                best_gain = gain;
+            }
+        }
+        if (!best_gain) break;
+        *committees[best] |= candidates[best].aggregation_bits;
+        ret.push_back(candidates[best]);
+    }
+    return ret;
+}
+
+void bench_packer(bench::Suite &suite, std::size_t validators, std::size_t count, std::uint64_t seed) {
+    const auto name = "AttestationPacker/" + std::to_string(validators) + "/" + std::to_string(count);
+    if (!suite.enabled(name + "/lazy_greedy") && !suite.enabled(name + "/greedy")) return;
+    const auto candidates = epoch_aggregates(validators, count, seed);
+    const eth::Slot slot = constants::SLOTS_PER_EPOCH + 1;
+
+    auto packed = eth::AttestationPacker{slot}.pack(candidates);
+    auto attesters = [](const std::vector<eth::Attestation> &attestations) {
+        std::size_t ret = 0;
+        for (const auto &attestation : attestations) ret += attestation.aggregation_bits.count();
+        return ret;
+    };
+    // Both make the same choices
+    if (attesters(packed) != attesters(greedy(candidates, constants::MAX_ATTESTATIONS))) std::abort();
+
+    suite.run(name + "/lazy_greedy", 0, 0, [&] {
+        bench::do_not_optimize(eth::AttestationPacker{slot}.pack(candidates).size());
+    });
+    suite.run(name + "/greedy", 0, 0, [&] {
+        bench::do_not_optimize(greedy(candidates, constants::MAX_ATTESTATIONS).size());
+    });
+    std::cout << "    " << packed.size() << " attestations chosen, " << attesters(packed) << " attesters\n";
+}
+}  // namespace
+
+int main(int argc, const char *argv[]) {
+    auto config = parse(argc, argv);
+    if (!config) {
+        usage(argv[0]);  // NOLINT
+        return 1;
+    }
+
+    bench::Suite suite{config->options, std::cout};
+    for (auto validators : config->validators)
+        for (auto threads : config->threads) bench_pool(suite, validators, threads, config->seed);
+    for (auto validators : config->validators) bench_packer(suite, validators, config->aggregates, config->seed);
+
+    if (!config->json.empty()) {
+        std::ofstream json{config->json};
+        suite.write_json(json, {{"seed", std::to_string(config->seed)},
+                                {"repetitions", std::to_string(config->options.repetitions)},
+                                {"min_time", std::to_string(config->options.min_time)}});
+        if (!json) {
+            std::cout << "could not write " << config->json << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
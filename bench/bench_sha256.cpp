@@ -0,0 +1,56 @@
+/*  bench_sha256.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "bench/bench_sha256_impl.hpp"
+#include "ssz/hasher.hpp"
+#include "ssz/hashtree.hpp"
+
+// Times the state root with every hasher available on this CPU, or only with the ones named in the command line
+int main(int argc, const char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " <state.ssz> [implementation...]\n";
+        return 1;
+    }
+
+    std::vector<ssz::Hasher::IMPL> impls;
+    for (int i = 2; i < argc; ++i) {
+        auto impl = ssz::Hasher::from_name(argv[i]);
+        if (!(ssz::Hasher::implemented() & impl)) {
+            std::cout << argv[i] << " is not available on this CPU\n";
+            return 1;
+        }
+        impls.push_back(impl);
+    }
+    if (impls.empty()) impls = ssz::Hasher::available();
+
+    std::cout << "Implementation         Average (ms)       Slowest\n";
+    std::cout << "-------------------------------------------------\n";
+    for (auto impl : impls) {
+        ssz::HashTree::hasher(impl);
+        std::cout << std::left << std::setw(10) << ssz::Hasher::name(impl) << ":             ";  // NOLINT
+        if (auto ret = bench::bench_sha256_impl(argv[1])) return ret;
+    }
+    return 0;
+}
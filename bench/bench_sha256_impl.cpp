@@ -21,14 +21,13 @@
 
 #include <chrono>
 #include <cstdint>
-#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>
-#include <vector>
 
 #include "beacon-chain/beacon_state.hpp"
 #include "bench/bench_sha256_impl.hpp"
+#include "ssz/stream.hpp"
 
 namespace {
 constexpr auto BENCH_ROUNDS = 10;
@@ -42,17 +41,10 @@ int bench::bench_sha256_impl(const char* path) {
         return 1;
     }
 
-    const auto size = std::filesystem::file_size(path);
-    std::vector<std::uint8_t> content(size);
-    // NOLINTNEXTLINE
-    if (!ssz_file.read(reinterpret_cast<char *>(content.data()), size)) {
-        std::cout << "could not read from file.\n";
-        return 1;
-    }
-    ssz_file.close();
-
+    // Decoded as it is read from disk
     auto obj = std::make_unique<eth::BeaconState>();
-    if (!obj->deserialize(content.begin(), content.end())) {
+    ssz::StreamReader reader{ssz_file};
+    if (!ssz::deserialize(reader, *obj)) {
         std::cout << "could not deserialize Beacon State\n";
         return 1;
     }
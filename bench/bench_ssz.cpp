@@ -0,0 +1,343 @@
+/*  bench_ssz.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Times serialize, deserialize, hash_tree_root and YAML decode of the SSZ containers on synthetic objects, and the
+ *  SHA256 kernels on their own. BeaconStates are generated for each of the validator counts given. Built with
+ *  HASHER_STATS the hash rates of hash_tree_root are reported and the hashing of each state is broken down by type.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "beacon-chain/attestation.hpp"
+#include "beacon-chain/beacon_block.hpp"
+#include "beacon-chain/beacon_state.hpp"
+#include "beacon-chain/deposits.hpp"
+#include "beacon-chain/eth1data.hpp"
+#include "beacon-chain/validator.hpp"
+#include "bench/bench.hpp"
+#include "bench/synthetic.hpp"
+#include "common/bitlist.hpp"
+#include "common/bitvector.hpp"
+#include "common/containers.hpp"
+#include "helpers/thread_pool.hpp"
+#include "ssz/arena.hpp"
+#include "ssz/hash_stats.hpp"
+#include "ssz/hasher.hpp"
+#include "ssz/hashtree.hpp"
+#include "ssz/stream.hpp"
+#include "ssz/trace.hpp"
+
+namespace {
+constexpr std::size_t SHA256_BLOCKS = 1024;
+constexpr double PARTICIPATION = 0.5;
+
+struct Config {
+    bench::Options options;
+    std::vector<std::size_t> validators{100000, 500000, 1000000};  // NOLINT
+    std::size_t threads = 0;
+    std::uint64_t seed = 0;
+    std::string json;
+    std::string trace;
+};
+
+// Set by --trace, each object is serialized, deserialized and hashed once under ssz::Trace before it is timed
+bool tracing = false;  // NOLINT
+
+void usage(const char *name) {
+    std::cout << "Usage: " << name << " [options]\n"
+              << "  --validators N[,N...]  validator counts of the BeaconStates (100000,500000,1000000)\n"
+              << "  --repetitions N        samples of each benchmark (20)\n"
+              << "  --min-time S           seconds that each sample runs at least (0.05)\n"
+              << "  --filter STR           only run the benchmarks whose name contains STR\n"
+              << "  --threads N            hash on a thread pool of N threads (none)\n"
+              << "  --hasher NAME          SHA256 implementation, MAMMON_HASHER otherwise\n"
+              << "  --seed N               seed of the synthetic objects (0)\n"
+              << "  --json PATH            write the results as JSON to PATH\n"
+              << "  --trace PATH           write a Chrome trace of each object to PATH, needs SSZ_TRACE\n"
+              << "YAML decode of the BeaconState only runs on the smallest state.\n";
+}
+
+std::vector<std::size_t> parse_list(std::string_view str) {
+    std::vector<std::size_t> ret;
+    while (!str.empty()) {
+        auto comma = std::min(str.find(','), str.size());
+        ret.push_back(std::stoull(std::string(str.substr(0, comma))));
+        str.remove_prefix(std::min(comma + 1, str.size()));
+    }
+    return ret;
+}
+
+std::optional<Config> parse(int argc, const char *argv[]) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg{argv[i]};  // NOLINT
+        if (i + 1 == argc) return std::nullopt;
+        std::string value{argv[++i]};  // NOLINT
+        if (arg == "--validators")
+            config.validators = parse_list(value);
+        else if (arg == "--repetitions")
+            config.options.repetitions = std::max<std::size_t>(1, std::stoull(value));
+        else if (arg == "--min-time")
+            config.options.min_time = std::stod(value);
+        else if (arg == "--filter")
+            config.options.filter = value;
+        else if (arg == "--threads")
+            config.threads = std::stoull(value);
+        else if (arg == "--hasher") {
+            auto impl = ssz::Hasher::from_name(value);
+            if (!(ssz::Hasher::implemented() & impl)) return std::nullopt;
+            ssz::HashTree::hasher(impl);
+        } else if (arg == "--seed")
+            config.seed = std::stoull(value);
+        else if (arg == "--json")
+            config.json = value;
+        else if (arg == "--trace" && ssz::Trace::enabled)
+            config.trace = value;
+        else
+            return std::nullopt;
+    }
+    std::sort(config.validators.begin(), config.validators.end());
+    return config;
+}
+
+// SHA256 blocks of the root of a fresh copy of object, only counted when built with HASHER_STATS
+template <class T>
+std::size_t hashes(const T &object) {
+    if constexpr (!ssz::HashStats::enabled) return 0;
+    auto copy = std::make_unique<T>(object);
+    ssz::HashStats::reset();
+    copy->hash_tree_root();
+    return ssz::HashStats::snapshot().blocks;
+}
+
+template <class T>
+void trace(const T &sample, const std::vector<std::uint8_t> &encoded) {
+    auto copy = std::make_unique<T>(sample);
+    auto object = std::make_unique<T>();
+    ssz::Trace::start();
+    bench::do_not_optimize(sample.serialize().data());
+    if (!object->deserialize(encoded.cbegin(), encoded.cend())) std::abort();
+    bench::do_not_optimize(copy->hash_tree_root());
+    ssz::Trace::stop();
+}
+
+// Throughputs of all operations are over the length of the SSZ encoding
+template <class T>
+void bench_container(bench::Suite &suite, const std::string &name, const T &sample, bool yaml = true) {
+    auto encoded = sample.serialize();
+    const auto size = encoded.size();
+    if (tracing && suite.enabled(name)) trace(sample, encoded);
+
+    std::vector<std::uint8_t> buffer(size);
+    suite.run(name + "/serialize", size, 0, [&] {
+        sample.serialize_into(buffer);
+        bench::do_not_optimize(buffer.data());
+    });
+
+    auto object = std::make_unique<T>();
+    suite.run(name + "/deserialize", size, 0, [&] {
+        if (!object->deserialize(encoded.cbegin(), encoded.cend())) std::abort();
+    });
+
+    // Short lived objects as those from gossip, decoded on the heap and in an arena that is freed at once
+    suite.run(name + "/deserialize_new", size, 0, [&] {
+        auto fresh = std::make_unique<T>();
+        if (!fresh->deserialize(encoded.cbegin(), encoded.cend())) std::abort();
+    });
+    suite.run(name + "/deserialize_arena", size, 0, [&] {
+        ssz::Arena arena{2 * size + sizeof(T)};
+        if (!arena.deserialize<T>(encoded.cbegin(), encoded.cend())) std::abort();
+    });
+
+    // Every sample hashes fresh copies, the cached trees of the validators and balances start empty
+    const auto blocks = suite.enabled(name + "/hash_tree_root") ? hashes(sample) : 0;
+    suite.run(
+        name + "/hash_tree_root", size, blocks, [&] { return std::make_unique<T>(sample); },
+        [](auto &copy) { bench::do_not_optimize(copy->hash_tree_root()); });
+
+    if (!yaml) return;
+    auto node = sample.encode();
+    suite.run(name + "/yaml_decode", size, 0, [&] {
+        if (!object->decode(node)) std::abort();
+    });
+}
+
+template <class T>
+void bench_container(bench::Suite &suite, const std::string &name, bench::Generator &gen) {
+    bench_container(suite, name, *gen.template make<T>());
+}
+
+void bench_sha256(bench::Suite &suite) {
+    std::vector<unsigned char> input(SHA256_BLOCKS * 2 * constants::BYTES_PER_CHUNK);
+    std::vector<unsigned char> output(SHA256_BLOCKS * constants::BYTES_PER_CHUNK);
+    for (std::size_t i = 0; i < input.size(); ++i) input[i] = static_cast<unsigned char>(i);
+    for (auto impl : ssz::Hasher::available()) {
+        const auto &hasher = ssz::Hasher::instance(impl);
+        suite.run("sha256/" + std::string(ssz::Hasher::name(impl)), input.size(), SHA256_BLOCKS, [&] {
+            hasher.hash_64b_blocks(output.data(), input.data(), SHA256_BLOCKS);
+            bench::do_not_optimize(output.data());
+        });
+    }
+}
+
+// The common containers and those of a block, with full committees and a full block body
+void bench_objects(bench::Suite &suite, std::uint64_t seed) {
+    auto shape = bench::block_shape(0, PARTICIPATION);
+    shape.committee_size = constants::MAX_VALIDATORS_PER_COMMITTEE;
+    bench::Generator gen{shape, seed};
+
+    eth::Bitlist bitlist{constants::MAX_VALIDATORS_PER_COMMITTEE};
+    gen.fill(bitlist, constants::MAX_VALIDATORS_PER_COMMITTEE);
+    bench_container(suite, "Bitlist", bitlist);
+    eth::Bitvector<constants::JUSTIFICATION_BITS_LENGTH> bitvector;
+    gen.fill(bitvector);
+    bench_container(suite, "Bitvector", bitvector);
+
+    bench_container<eth::Fork>(suite, "Fork", gen);
+    bench_container<eth::ForkData>(suite, "ForkData", gen);
+    bench_container<eth::Checkpoint>(suite, "Checkpoint", gen);
+    bench_container<eth::SigningData>(suite, "SigningData", gen);
+    bench_container<eth::Validator>(suite, "Validator", gen);
+    bench_container<eth::Eth1Data>(suite, "Eth1Data", gen);
+    bench_container<eth::DepositMessage>(suite, "DepositMessage", gen);
+    bench_container<eth::DepositData>(suite, "DepositData", gen);
+    bench_container<eth::Deposit>(suite, "Deposit", gen);
+    bench_container<eth::AttestationData>(suite, "AttestationData", gen);
+    bench_container<eth::Attestation>(suite, "Attestation", gen);
+    bench_container<eth::PendingAttestation>(suite, "PendingAttestation", gen);
+    bench_container<eth::IndexedAttestation>(suite, "IndexedAttestation", gen);
+    bench_container<eth::BeaconBlockHeader>(suite, "BeaconBlockHeader", gen);
+    bench_container<eth::SignedBeaconBlockHeader>(suite, "SignedBeaconBlockHeader", gen);
+    bench_container<eth::VoluntaryExit>(suite, "VoluntaryExit", gen);
+    bench_container<eth::SignedVoluntaryExit>(suite, "SignedVoluntaryExit", gen);
+    bench_container<eth::ProposerSlashing>(suite, "ProposerSlashing", gen);
+    bench_container<eth::AttesterSlashing>(suite, "AttesterSlashing", gen);
+    bench_container<eth::BeaconBlockBody>(suite, "BeaconBlockBody", gen);
+    bench_container<eth::BeaconBlock>(suite, "BeaconBlock", gen);
+    bench_container<eth::SignedBeaconBlock>(suite, "SignedBeaconBlock", gen);
+}
+
+// A state shaped as in mainnet for the number of validators
+void bench_state(bench::Suite &suite, std::size_t validators, std::uint64_t seed, bool yaml) {
+    const auto name = "BeaconState/" + std::to_string(validators);
+    constexpr std::array<const char *, 9> operations{
+        "/serialize",   "/deserialize",           "/deserialize_new",   "/deserialize_arena", "/hash_tree_root",
+        "/yaml_decode", "/hash_tree_root_cached", "/file/read_decode", "/file/stream"};
+    if (std::none_of(operations.cbegin(), operations.cend(),
+                     [&](const auto *operation) { return suite.enabled(name + operation); }))
+        return;
+    const auto history = validators / constants::SLOTS_PER_EPOCH;
+    bench::Generator gen{bench::state_shape(validators, history, PARTICIPATION), seed};
+    auto state = gen.make<eth::BeaconState>();
+    bench_container(suite, name, *state, yaml);
+
+    if (ssz::HashStats::enabled && suite.enabled(name + "/hash_tree_root")) {
+        ssz::HashStats::reset();
+        std::make_unique<eth::BeaconState>(*state)->hash_tree_root();
+        std::cout << '\n' << name << " hashing by type:\n";
+        ssz::HashStats::dump(std::cout);
+        std::cout << '\n';
+    }
+    state->hash_tree_root();
+    suite.run(name + "/hash_tree_root_cached", state->serialized_size(), 0,
+              [&] { bench::do_not_optimize(state->hash_tree_root()); });
+
+    // Loading a state from a file, cached by the OS: read whole and then decoded, or decoded as it is read
+    if (!suite.enabled(name + "/file/read_decode") && !suite.enabled(name + "/file/stream")) return;
+    const auto path = std::filesystem::temp_directory_path() / ("bench_ssz_state_" + std::to_string(validators));
+    const auto encoded = state->serialize();
+    std::ofstream{path, std::ios::binary}.write(reinterpret_cast<const char *>(encoded.data()),  // NOLINT
+                                                std::streamsize(encoded.size()));
+    auto object = std::make_unique<eth::BeaconState>();
+    suite.run(name + "/file/read_decode", encoded.size(), 0, [&] {
+        std::ifstream file{path, std::ios::binary};
+        std::vector<std::uint8_t> content(std::filesystem::file_size(path));
+        file.read(reinterpret_cast<char *>(content.data()), std::streamsize(content.size()));  // NOLINT
+        if (!file || !object->deserialize(content.cbegin(), content.cend())) std::abort();
+    });
+    suite.run(name + "/file/stream", encoded.size(), 0, [&] {
+        std::ifstream file{path, std::ios::binary};
+        ssz::StreamReader reader{file};
+        if (!ssz::deserialize(reader, *object)) std::abort();
+    });
+    std::filesystem::remove(path);
+}
+}  // namespace
+
+int main(int argc, const char *argv[]) {
+    auto config = parse(argc, argv);
+    if (!config) {
+        usage(argv[0]);  // NOLINT
+        return 1;
+    }
+
+    std::unique_ptr<helpers::ThreadPool> pool;
+    if (config->threads) {
+        pool = std::make_unique<helpers::ThreadPool>(config->threads);
+        ssz::HashTree::thread_pool(pool.get());
+        ssz::Container::thread_pool(pool.get());
+    }
+
+    tracing = !config->trace.empty();
+    bench::Suite suite{config->options, std::cout};
+    bench_sha256(suite);
+    bench_objects(suite, config->seed);
+    for (auto validators : config->validators)
+        bench_state(suite, validators, config->seed, validators == config->validators.front());
+
+    if (tracing) {
+        std::cout << '\n';
+        ssz::Trace::dump(std::cout);
+        std::ofstream trace{config->trace};
+        ssz::Trace::write_chrome_trace(trace);
+        if (!trace) {
+            std::cout << "could not write " << config->trace << '\n';
+            return 1;
+        }
+    }
+
+    if (!config->json.empty()) {
+        std::ofstream json{config->json};
+        std::string sizes;
+        for (auto validators : config->validators) sizes += (sizes.empty() ? "" : ",") + std::to_string(validators);
+        suite.write_json(json, {{"hasher", std::string(ssz::Hasher::name(ssz::HashTree::hasher().impl()))},
+                                {"threads", std::to_string(config->threads)},
+                                {"validators", sizes},
+                                {"seed", std::to_string(config->seed)},
+                                {"repetitions", std::to_string(config->options.repetitions)},
+                                {"min_time", std::to_string(config->options.min_time)}});
+        if (!json) {
+            std::cout << "could not write " << config->json << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
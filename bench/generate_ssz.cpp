@@ -0,0 +1,151 @@
+/*  generate_ssz.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Writes a synthetic BeaconState, SignedBeaconBlock and list of gossip attestations as SSZ files, optionally
+ *  compressed with snappy as in the spec tests. The same options always give the same files.
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "beacon-chain/attestation.hpp"
+#include "beacon-chain/beacon_block.hpp"
+#include "beacon-chain/beacon_state.hpp"
+#include "bench/synthetic.hpp"
+#include "common/containers.hpp"
+#include "helpers/bytes_to_string.hpp"
+#include "snappy.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+struct Config {
+    fs::path out;
+    std::size_t validators = 16384;  // NOLINT
+    std::size_t history = 0;
+    std::size_t attestations = 16384;  // NOLINT
+    std::size_t data = 64;             // NOLINT
+    double participation = 0.9;        // NOLINT
+    std::uint64_t seed = 0;
+    bool snappy = false;
+};
+
+void usage(const char *name) {
+    std::cout << "Usage: " << name << " --out DIR [options]\n"
+              << "  --validators N     validators of the state, sets the committee sizes (16384)\n"
+              << "  --history N        length of historical_roots (0)\n"
+              << "  --participation P  fraction of the aggregation bits set (0.9)\n"
+              << "  --attestations N   gossip attestations in attestations.ssz (16384)\n"
+              << "  --data N           distinct AttestationData among them (64)\n"
+              << "  --seed N           seed of the generator (0)\n"
+              << "  --snappy           also write each file compressed as .ssz_snappy\n";
+}
+
+std::optional<Config> parse(int argc, const char *argv[]) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg{argv[i]};  // NOLINT
+        if (arg == "--snappy") {
+            config.snappy = true;
+            continue;
+        }
+        if (i + 1 == argc) return std::nullopt;
+        std::string value{argv[++i]};  // NOLINT
+        if (arg == "--out")
+            config.out = value;
+        else if (arg == "--validators")
+            config.validators = std::stoull(value);
+        else if (arg == "--history")
+            config.history = std::stoull(value);
+        else if (arg == "--participation")
+            config.participation = std::stod(value);
+        else if (arg == "--attestations")
+            config.attestations = std::stoull(value);
+        else if (arg == "--data")
+            config.data = std::stoull(value);
+        else if (arg == "--seed")
+            config.seed = std::stoull(value);
+        else
+            return std::nullopt;
+    }
+    if (config.out.empty()) return std::nullopt;
+    return config;
+}
+
+bool write(const fs::path &path, const std::vector<std::uint8_t> &content) {
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    file.write(reinterpret_cast<const char *>(content.data()), std::streamsize(content.size()));  // NOLINT
+    return bool(file);
+}
+
+// Writes name.ssz and, when asked, name.ssz_snappy, and prints the size and root of the object
+bool write(const Config &config, const std::string &name, const ssz::Container &object) {
+    auto encoded = object.serialize();
+    if (!write(config.out / (name + ".ssz"), encoded)) return false;
+    if (config.snappy) {
+        std::string compressed;
+        snappy::Compress(reinterpret_cast<const char *>(encoded.data()), encoded.size(), &compressed);  // NOLINT
+        if (!write(config.out / (name + ".ssz_snappy"), {compressed.cbegin(), compressed.cend()})) return false;
+    }
+    std::cout << name << ".ssz: " << encoded.size() << " bytes, root "
+              << helpers::bytes_to_string(object.hash_tree_root()) << '\n';
+    return true;
+}
+}  // namespace
+
+int main(int argc, const char *argv[]) {
+    auto config = parse(argc, argv);
+    if (!config) {
+        usage(argv[0]);  // NOLINT
+        return 1;
+    }
+    std::error_code ec;
+    fs::create_directories(config->out, ec);
+    if (ec) {
+        std::cout << "could not create " << config->out << '\n';
+        return 1;
+    }
+
+    // Each object has its own generator so that changing one option does not change the other files
+    bench::Generator state_gen{bench::state_shape(config->validators, config->history, config->participation),
+                               config->seed};
+    auto state = state_gen.make<eth::BeaconState>();
+
+    bench::Generator block_gen{bench::block_shape(config->validators, config->participation), config->seed};
+    auto block = block_gen.make<eth::SignedBeaconBlock>();
+
+    bench::Generator attestation_gen{bench::block_shape(config->validators, config->participation), config->seed};
+    eth::ListVariableSizedParts<eth::Attestation> attestations{config->attestations};
+    auto generated = attestation_gen.attestations(config->attestations, config->data);
+    attestations.data().assign(generated.cbegin(), generated.cend());
+
+    if (!write(*config, "state", *state) || !write(*config, "block", *block) ||
+        !write(*config, "attestations", attestations)) {
+        std::cout << "could not write to " << config->out << '\n';
+        return 1;
+    }
+    return 0;
+}
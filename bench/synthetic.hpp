@@ -0,0 +1,215 @@
+/*  synthetic.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "beacon-chain/attestation.hpp"
+#include "beacon-chain/validator_registry.hpp"
+#include "common/bitlist.hpp"
+#include "common/bitvector.hpp"
+#include "common/bytes.hpp"
+#include "common/containers.hpp"
+#include "config/constants.hpp"
+#include "include/config.hpp"
+#include "ssz/schema.hpp"
+
+namespace bench {
+// Lengths of the lists of a synthetic object, by the name of the field that holds them. Lists not named here are
+// left empty.
+struct Shape {
+    std::size_t validators = 0;            // validators and balances
+    std::size_t committee_size = 0;        // aggregation_bits and attesting_indices
+    std::size_t pending_attestations = 0;  // each of previous_epoch_attestations and current_epoch_attestations
+    std::size_t block_attestations = 0;    // attestations of a block body
+    std::size_t historical_roots = 0;
+    std::size_t eth1_data_votes = 0;
+    std::size_t operations = 0;  // each of the slashings, deposits and voluntary exits lists of a block body
+    double participation = 0.5;  // NOLINT fraction of the aggregation bits that are set
+
+    std::size_t length(std::string_view field) const {
+        if (field == "validators" || field == "balances") return validators;
+        if (field == "aggregation_bits" || field == "attesting_indices") return committee_size;
+        if (field == "previous_epoch_attestations" || field == "current_epoch_attestations")
+            return pending_attestations;
+        if (field == "attestations") return block_attestations;
+        if (field == "historical_roots") return historical_roots;
+        if (field == "eth1_data_votes") return eth1_data_votes;
+        if (field == "proposer_slashings" || field == "attester_slashings" || field == "deposits" ||
+            field == "voluntary_exits")
+            return operations;
+        return 0;
+    }
+};
+
+// Committees as in mainnet for a registry of the given size
+inline std::size_t committee_size(std::size_t validators) {
+    return std::clamp<std::size_t>(validators / (constants::SLOTS_PER_EPOCH * constants::MAX_COMMITTEES_PER_SLOT), 1,
+                                   constants::MAX_VALIDATORS_PER_COMMITTEE);
+}
+
+// A state with full pending attestation lists and half of the eth1 voting period, history is the length of
+// historical_roots
+inline Shape state_shape(std::size_t validators, std::size_t history, double participation) {
+    return {.validators = validators,
+            .committee_size = committee_size(validators),
+            .pending_attestations = constants::MAX_ATTESTATIONS * constants::SLOTS_PER_EPOCH,
+            .historical_roots = history,
+            .eth1_data_votes = constants::EPOCHS_PER_ETH1_VOTING_PERIOD * constants::SLOTS_PER_EPOCH / 2,
+            .participation = participation};
+}
+
+// A block with the maximum number of attestations and as many operations as the shortest of their lists allows
+inline Shape block_shape(std::size_t validators, double participation) {
+    return {.committee_size = committee_size(validators),
+            .block_attestations = constants::MAX_ATTESTATIONS,
+            .operations = constants::MAX_ATTESTER_SLASHINGS,
+            .participation = participation};
+}
+
+/**
+ *   \brief Builds SSZ objects with deterministic pseudorandom contents.
+ *   \details Containers are filled field by field through their schema, the length of each list is taken from the
+ *   Shape by the name of the field. The same seed and shape always give the same object.
+ */
+class Generator {
+   private:
+    std::mt19937_64 gen_;
+    Shape shape_;
+
+    // An element of a list or a vector, packed ones are filled through a copy
+    template <class T, class Reference>
+    void fill_element(Reference &&element) {
+        if constexpr (eth::PackedObject<T>) {
+            T object;
+            fill(object);
+            element = object;
+        } else
+            fill(element);
+    }
+
+   public:
+    explicit Generator(Shape shape, std::uint64_t seed = 0) : gen_{seed}, shape_{shape} {}
+
+    const Shape &shape() const { return shape_; }
+    std::uint64_t word() { return gen_(); }
+    // In [0, 1), from the top 53 bits of a word so that it does not depend on the standard library
+    double uniform() { return double(word() >> 11U) * 0x1p-53; }  // NOLINT
+
+    void fill(eth::Slot &value) { static_cast<std::uint64_t &>(value) = word(); }
+    void fill(eth::Boolean &value) { static_cast<bool &>(value) = word() & 1; }
+
+    template <std::size_t N>
+    void fill(eth::Bytes<N> &value) {
+        for (auto &byte : value) byte = std::uint8_t(word());
+    }
+
+    template <unsigned N>
+    void fill(eth::Bitvector<N> &value) {
+        for (std::size_t i = 0; i < N; ++i) value.set(i, word() & 1);
+    }
+
+    // Shape::participation of the bits are set
+    void fill(eth::Bitlist &value, std::size_t length) {
+        value.resize(length);
+        for (std::size_t i = 0; i < length; ++i) value.set(i, uniform() < shape_.participation);
+    }
+
+    template <class T, std::size_t N>
+    void fill(eth::VectorFixedSizedParts<T, N> &value) {
+        for (auto &&element : value) fill_element<T>(element);
+    }
+
+    template <class T>
+    void fill(eth::ListFixedSizedParts<T> &value, std::size_t length) {
+        value.resize(length);
+        for (auto &&element : value) fill_element<T>(element);
+    }
+
+    template <class T>
+    void fill(eth::CachedListFixedSizedParts<T> &value, std::size_t length) {
+        value.resize(length);
+        for (auto &&element : value) fill_element<T>(element);
+    }
+
+    template <class T>
+    void fill(eth::ListVariableSizedParts<T> &value, std::size_t length) {
+        auto &elements = value.data();
+        elements.resize(length);
+        for (auto &element : elements) fill(element);
+    }
+
+    void fill(eth::ValidatorRegistry &value, std::size_t length) {
+        eth::Validator validator;
+        for (std::size_t i = 0; i < length; ++i) {
+            fill(validator);
+            value.push_back(validator);
+        }
+    }
+
+    template <ssz::HasFields T>
+    void fill(T &value) {
+        std::apply(
+            [&](const auto &...f) {
+                auto fill_field = [this](auto &member, std::string_view name) {
+                    if constexpr (requires { fill(member, std::size_t{}); })
+                        fill(member, shape_.length(name));
+                    else
+                        fill(member);
+                };
+                (fill_field(value.*f.member, f.name), ...);
+            },
+            T::fields());
+    }
+
+    /**
+     *   \brief Attestations as received from gossip, for committees of Shape::committee_size.
+     *   \details They vote for one of distinct_data random AttestationData, so that each data is shared by about
+     *   count / distinct_data attestations with overlapping bits.
+     */
+    std::vector<eth::Attestation> attestations(std::size_t count, std::size_t distinct_data) {
+        std::vector<eth::AttestationData> data(std::max<std::size_t>(distinct_data, 1));
+        for (auto &d : data) fill(d);
+        std::vector<eth::Attestation> ret(count);
+        for (auto &attestation : ret) {
+            attestation.data = data[word() % data.size()];
+            fill(attestation.aggregation_bits, shape_.committee_size);
+            fill(attestation.signature);
+        }
+        return ret;
+    }
+
+    // Objects are returned on the heap, a BeaconState holds several MB of fixed size vectors
+    template <class T>
+    std::unique_ptr<T> make() {
+        auto ret = std::make_unique<T>();
+        fill(*ret);
+        return ret;
+    }
+};
+}  // namespace bench
@@ -21,44 +21,137 @@
 
 #include "bitlist.hpp"
 
+#include <algorithm>
 #include <bit>
 #include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
 #include "config.hpp"
 #include "helpers/bytes_to_int.hpp"
 #include "ssz/hashtree.hpp"
 
 namespace eth {
+namespace {
+// Copies count bytes of the little endian image of words to out
+void words_to_bytes(const std::uint64_t *words, std::size_t count, std::uint8_t *out) {
+    if (!count) return;
+    if constexpr (std::endian::native == std::endian::little)
+        std::memcpy(out, words, count);
+    else
+        for (std::size_t i = 0; i < count; ++i) out[i] = std::uint8_t(words[i / 8] >> (8 * (i % 8)));  // NOLINT
+}
+
+void bytes_to_words(const std::uint8_t *in, std::size_t count, std::uint64_t *words) {
+    if (!count) return;
+    if constexpr (std::endian::native == std::endian::little)
+        std::memcpy(words, in, count);
+    else
+        for (std::size_t i = 0; i < count; ++i) words[i / 8] |= std::uint64_t{in[i]} << (8 * (i % 8));  // NOLINT
+}
+}  // namespace
+
 std::vector<ssz::Chunk> Bitlist::hash_tree() const {
+    SSZ_TRACE_SCOPE("hash_tree");
     using namespace constants;
-    std::vector<std::uint8_t> ret((m_arr.size() + BITS_PER_BYTE - 1) / BITS_PER_BYTE, 0);
-    for (int i = 0; i < m_arr.size(); ++i) ret[i / constants::BITS_PER_BYTE] |= m_arr[i] << (i % BITS_PER_BYTE);
     auto limit = (limit_ + BITS_PER_BYTE * BYTES_PER_CHUNK - 1) / (BITS_PER_BYTE * BYTES_PER_CHUNK);
-    ssz::HashTree ht{ret, limit};
-    ht.mix_in(m_arr.size());
-    return ht.hash_tree();
+    ssz::Merkleizer merkleizer{limit};
+    if constexpr (std::endian::native == std::endian::little)
+        merkleizer.pack({reinterpret_cast<const std::uint8_t *>(words_.data()), byte_size()});  // NOLINT
+    else {
+        std::vector<std::uint8_t> bytes(byte_size());
+        words_to_bytes(words_.data(), bytes.size(), bytes.data());
+        merkleizer.pack(bytes);
+    }
+    return {merkleizer.hash_tree_root(size_)};
+}
+
+void Bitlist::resize(std::size_t size) {
+    words_.resize((size + WORD_BITS - 1) / WORD_BITS);
+    if (size < size_ && size % WORD_BITS) words_.back() &= (std::uint64_t{1} << (size % WORD_BITS)) - 1;
+    size_ = size;
 }
 
-std::vector<std::uint8_t> Bitlist::serialize() const {
-    std::vector<std::uint8_t> ret(m_arr.size() / constants::BITS_PER_BYTE + 1, 0);
-    for (int i = 0; i < m_arr.size(); ++i)
-        ret[i / constants::BITS_PER_BYTE] |= m_arr[i] << (i % constants::BITS_PER_BYTE);
-    ret.back() |= 1 << (m_arr.size() % constants::BITS_PER_BYTE);
+void Bitlist::check_size(const Bitlist &other) const {
+    if (other.size_ != size_) throw std::invalid_argument("bitlists of different size");
+}
+
+std::size_t Bitlist::count() const {
+    std::size_t ret = 0;
+    for (auto word : words_) ret += std::popcount(word);
     return ret;
 }
-bool Bitlist::deserialize(ssz::SSZIterator it, ssz::SSZIterator end) {
-    auto last = end;
-    --last;
-    int msb = std::countl_zero(*last);
-    m_arr.clear();
 
-    for (auto i = it; i != last; ++i)
-        for (auto j = 0; j < constants::BITS_PER_BYTE; ++j) m_arr.push_back((*i >> j) & 1);
+bool Bitlist::none() const {
+    return std::all_of(words_.cbegin(), words_.cend(), [](auto word) { return word == 0; });
+}
+
+Bitlist &Bitlist::operator|=(const Bitlist &other) {
+    check_size(other);
+    for (std::size_t i = 0; i < words_.size(); ++i) words_[i] |= other.words_[i];
+    return *this;
+}
+
+Bitlist &Bitlist::operator&=(const Bitlist &other) {
+    check_size(other);
+    for (std::size_t i = 0; i < words_.size(); ++i) words_[i] &= other.words_[i];
+    return *this;
+}
+
+// The loops below have no early exit so that they are vectorized, bitlists are at most a few words long
+bool Bitlist::is_subset_of(const Bitlist &other) const {
+    check_size(other);
+    std::uint64_t outside = 0;
+    for (std::size_t i = 0; i < words_.size(); ++i) outside |= words_[i] & ~other.words_[i];
+    return outside == 0;
+}
+
+bool Bitlist::intersects(const Bitlist &other) const {
+    check_size(other);
+    std::uint64_t common = 0;
+    for (std::size_t i = 0; i < words_.size(); ++i) common |= words_[i] & other.words_[i];
+    return common != 0;
+}
+
+std::size_t Bitlist::count_not_in(const Bitlist &other) const {
+    check_size(other);
+    std::size_t ret = 0;
+    for (std::size_t i = 0; i < words_.size(); ++i) ret += std::popcount(words_[i] & ~other.words_[i]);
+    return ret;
+}
+
+std::size_t Bitlist::serialized_size() const { return size_ / constants::BITS_PER_BYTE + 1; }
+
+std::size_t Bitlist::serialize_into(std::span<std::uint8_t> out) const {
+    SSZ_TRACE_SCOPE("serialize_into");
+    auto size = serialized_size();
+    if (out.size() < size) throw std::out_of_range("buffer too small for SSZ encoding");
+    // The delimiter goes in the last byte, which holds no bits when the size is a multiple of 8
+    out[size - 1] = 0;
+    words_to_bytes(words_.data(), byte_size(), out.data());
+    out[size - 1] |= std::uint8_t(1U << (size_ % constants::BITS_PER_BYTE));
+    return size;
+}
 
-    for (auto i = 0; i < constants::BITS_PER_BYTE - 1 - msb; ++i) m_arr.push_back((*last >> i) & 1);
+bool Bitlist::deserialize(ssz::SSZIterator it, ssz::SSZIterator end) {
+    SSZ_TRACE_SCOPE("deserialize");
+    const auto bytes = std::size_t(std::distance(it, end));
+    if (!bytes || !*(end - 1)) return false;
+    const auto last = *(end - 1);
+    const auto msb = std::size_t(std::bit_width(last)) - 1;
+    const auto size = (bytes - 1) * constants::BITS_PER_BYTE + msb;
+    if (limit_ && size > limit_) return false;
+
+    words_.assign((size + WORD_BITS - 1) / WORD_BITS, 0);
+    size_ = size;
+    bytes_to_words(&*it, bytes - 1, words_.data());
+    if (msb) {
+        const auto bits = std::uint64_t(last & ((1U << msb) - 1U));
+        words_[(bytes - 1) / 8] |= bits << (8 * ((bytes - 1) % 8));  // NOLINT
+    }
     return true;
 }
 
@@ -82,7 +175,8 @@ std::string Bitlist::to_string() const {
     std::ios_base::fmtflags save = std::cout.flags();
     auto serial = this->serialize();
     os << "0x";
-    for (auto i = serial.cbegin(); i != serial.cend(); ++i) os << std::setfill('0') << std::setw(2) << std::hex << *i;
+    for (auto i = serial.cbegin(); i != serial.cend(); ++i)
+        os << std::setfill('0') << std::setw(2) << std::hex << unsigned(*i);
     std::cout.flags(save);
     return os.str();
 };
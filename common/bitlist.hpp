@@ -20,34 +20,72 @@
  */
 
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <ostream>
+#include <span>
 #include <vector>
 
+#include "ssz/arena.hpp"
 #include "ssz/ssz_container.hpp"
 #include "yaml-cpp/yaml.h"
 
 namespace eth {
+/**
+ *   \brief A list of bits packed in 64 bit words.
+ *   \details Bit i is bit i % 64 of word i / 64 and the bits past size() are always zero, so that on little endian
+ *   machines the bytes of the words are the SSZ encoding without its delimiter bit and are packed into chunks as
+ *   they are. The set operations work a word at a time and require bitlists of the same size.
+ */
 class Bitlist : public ssz::Container {
    private:
-    std::vector<bool> m_arr;
+    static constexpr std::size_t WORD_BITS = 64;
+
+    ssz::vector<std::uint64_t> words_;
+    std::size_t size_ = 0;
     std::size_t limit_;
 
+    std::size_t byte_size() const { return (size_ + 7) / 8; }  // NOLINT
+    void check_size(const Bitlist &other) const;
+
    protected:
     std::vector<ssz::Chunk> hash_tree() const override;
 
    public:
     friend std::ostream &operator<<(std::ostream &os, const Bitlist &m_bits) {
-        for (auto const &b : m_bits.m_arr) os << b;
+        for (std::size_t i = 0; i < m_bits.size(); ++i) os << m_bits.test(i);
         return os;
     };
 
     Bitlist(std::size_t limit = 0) : limit_{limit} {};
+    std::size_t limit() const { return limit_; }
     void limit(std::size_t limit) { limit_ = limit; }
     void from_hexstring(const std::string &str);
     std::string to_string() const;
-    std::size_t size() const { return m_arr.size(); }
+    std::size_t size() const { return size_; }
+    // New bits are cleared
+    void resize(std::size_t size);
+
+    bool test(std::size_t index) const { return (words_[index / WORD_BITS] >> (index % WORD_BITS)) & 1U; }
+    void set(std::size_t index, bool value = true) {
+        const auto mask = std::uint64_t{1} << (index % WORD_BITS);
+        words_[index / WORD_BITS] = value ? words_[index / WORD_BITS] | mask : words_[index / WORD_BITS] & ~mask;
+    }
+    std::span<const std::uint64_t> words() const { return words_; }
+
+    // Number of bits set
+    std::size_t count() const;
+    bool none() const;
+    Bitlist &operator|=(const Bitlist &other);
+    Bitlist &operator&=(const Bitlist &other);
+    // Every bit set here is set in other
+    bool is_subset_of(const Bitlist &other) const;
+    bool intersects(const Bitlist &other) const;
+    // Number of bits set here and not in other
+    std::size_t count_not_in(const Bitlist &other) const;
 
-    std::vector<std::uint8_t> serialize() const override;
+    std::size_t serialized_size() const override;
+    std::size_t serialize_into(std::span<std::uint8_t> out) const override;
     bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override;
     bool operator==(const Bitlist &) const = default;
     YAML::Node encode() const override;
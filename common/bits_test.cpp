@@ -0,0 +1,188 @@
+/*  bits_test.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "common/bitlist.hpp"
+#include "common/bitvector.hpp"
+#include "include/acutest.h"
+#include "ssz/hashtree.hpp"
+
+namespace {
+constexpr std::size_t LIMIT = 2048;
+
+std::vector<bool> random_bits(std::size_t size, std::mt19937_64 &gen) {
+    std::vector<bool> ret(size);
+    for (std::size_t i = 0; i < size; ++i) ret[i] = gen() & 1U;
+    return ret;
+}
+
+eth::Bitlist make_bitlist(const std::vector<bool> &bits) {
+    eth::Bitlist ret{LIMIT};
+    ret.resize(bits.size());
+    for (std::size_t i = 0; i < bits.size(); ++i) ret.set(i, bits[i]);
+    return ret;
+}
+
+// The SSZ encoding, bit by bit
+std::vector<std::uint8_t> encoding(const std::vector<bool> &bits) {
+    std::vector<std::uint8_t> ret(bits.size() / 8 + 1);
+    for (std::size_t i = 0; i < bits.size(); ++i) ret[i / 8] |= std::uint8_t(bits[i] << (i % 8));
+    ret.back() |= std::uint8_t(1U << (bits.size() % 8));
+    return ret;
+}
+
+template <unsigned N>
+eth::Bitvector<N> make_bitvector(const std::vector<bool> &bits) {
+    eth::Bitvector<N> ret;
+    for (std::size_t i = 0; i < N; ++i) ret.set(i, bits[i]);
+    return ret;
+}
+
+template <unsigned N>
+void check_bitvector(std::mt19937_64 &gen) {
+    auto bits = random_bits(N, gen);
+    auto bitvector = make_bitvector<N>(bits);
+    auto expected = encoding(bits);
+    expected.resize(eth::Bitvector<N>::ssz_size);  // no delimiter
+    if (N % 8) expected.back() &= std::uint8_t((1U << (N % 8)) - 1);
+    TEST_CHECK(bitvector.serialize() == expected);  // NOLINT
+    TEST_MSG("N: %u", N);                           // NOLINT
+
+    eth::Bitvector<N> decoded;
+    TEST_CHECK(decoded.deserialize(expected.cbegin(), expected.cend()));  // NOLINT
+    TEST_CHECK(decoded == bitvector);                                    // NOLINT
+    decoded.from_hexstring(bitvector.to_string());
+    TEST_CHECK(decoded == bitvector);  // NOLINT
+
+    ssz::Merkleizer merkleizer{};
+    merkleizer.pack(expected);
+    TEST_CHECK(bitvector.hash_tree_root() == merkleizer.hash_tree_root());  // NOLINT
+
+    std::size_t count = 0;
+    for (auto bit : bits) count += bit;
+    TEST_CHECK(bitvector.count() == count);  // NOLINT
+
+    for (std::size_t shift : {0, 1, 3, 63, 64, 65, 130, 600}) {  // NOLINT
+        std::vector<bool> left(N), right(N);
+        for (std::size_t i = 0; i + shift < N; ++i) {
+            left[i + shift] = bits[i];
+            right[i] = bits[i + shift];
+        }
+        TEST_CHECK((eth::Bitvector<N>{bitvector} <<= shift) == make_bitvector<N>(left));   // NOLINT
+        TEST_CHECK((eth::Bitvector<N>{bitvector} >>= shift) == make_bitvector<N>(right));  // NOLINT
+        TEST_MSG("N: %u, shift: %zu", N, shift);                                           // NOLINT
+    }
+
+    // The length is exact and the padding bits are zero
+    expected.push_back(0);
+    TEST_CHECK(!decoded.deserialize(expected.cbegin(), expected.cend()));  // NOLINT
+    expected.pop_back();
+    if (N % 8) {
+        expected.back() |= std::uint8_t(1U << (N % 8));
+        TEST_CHECK(!decoded.deserialize(expected.cbegin(), expected.cend()));  // NOLINT
+    }
+}
+}  // namespace
+
+void test_bitlist_encoding() {
+    std::mt19937_64 gen{1};  // NOLINT
+    for (std::size_t size : {0, 1, 7, 8, 9, 63, 64, 65, 127, 128, 300, 2048}) {  // NOLINT
+        auto bits = random_bits(size, gen);
+        auto bitlist = make_bitlist(bits);
+        auto expected = encoding(bits);
+        TEST_CHECK(bitlist.serialize() == expected);  // NOLINT
+        TEST_MSG("size: %zu", size);                  // NOLINT
+
+        eth::Bitlist decoded{LIMIT};
+        TEST_CHECK(decoded.deserialize(expected.cbegin(), expected.cend()));  // NOLINT
+        TEST_CHECK(decoded == bitlist);                                      // NOLINT
+
+        std::vector<std::uint8_t> packed(expected.begin(), expected.end() - (size % 8 ? 0 : 1));
+        if (size % 8) packed.back() &= std::uint8_t((1U << (size % 8)) - 1);
+        ssz::Merkleizer merkleizer{LIMIT / 256};  // NOLINT
+        merkleizer.pack(packed);
+        TEST_CHECK(bitlist.hash_tree_root() == merkleizer.hash_tree_root(size));  // NOLINT
+        TEST_MSG("size: %zu", size);                                              // NOLINT
+    }
+
+    eth::Bitlist bitlist{8};  // NOLINT
+    for (const auto &invalid : std::vector<std::vector<std::uint8_t>>{{}, {0x01, 0x00}, {0xff, 0x02}})  // NOLINT
+        TEST_CHECK(!bitlist.deserialize(invalid.cbegin(), invalid.cend()));                            // NOLINT
+}
+
+void test_bitlist_operations() {
+    std::mt19937_64 gen{2};  // NOLINT
+    for (std::size_t size : {1, 64, 100, 2048}) {  // NOLINT
+        auto a = random_bits(size, gen), b = random_bits(size, gen);
+        std::vector<bool> both(size), either(size);
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            both[i] = a[i] && b[i];
+            either[i] = a[i] || b[i];
+            count += a[i];
+        }
+        auto x = make_bitlist(a), y = make_bitlist(b);
+        TEST_CHECK(x.count() == count);                          // NOLINT
+        TEST_CHECK((eth::Bitlist{x} |= y) == make_bitlist(either));  // NOLINT
+        TEST_CHECK((eth::Bitlist{x} &= y) == make_bitlist(both));    // NOLINT
+        TEST_CHECK(make_bitlist(both).is_subset_of(x));          // NOLINT
+        TEST_CHECK(x.is_subset_of(make_bitlist(either)));        // NOLINT
+        TEST_CHECK(x.intersects(y) == (make_bitlist(both).count() > 0));  // NOLINT
+        TEST_CHECK(x.count_not_in(y) == count - make_bitlist(both).count());  // NOLINT
+        TEST_MSG("size: %zu", size);                                    // NOLINT
+    }
+
+    auto x = make_bitlist({true, false, true}), y = make_bitlist({false, true, false});
+    TEST_CHECK(!x.intersects(y) && !x.is_subset_of(y));  // NOLINT
+    TEST_CHECK(eth::Bitlist{LIMIT}.none());              // NOLINT
+    TEST_EXCEPTION(x |= make_bitlist({true}), std::invalid_argument);  // NOLINT
+
+    // Shrinking clears the bits past the new size
+    auto bitlist = make_bitlist(std::vector<bool>(100, true));  // NOLINT
+    bitlist.resize(70);                                          // NOLINT
+    bitlist.resize(100);                                         // NOLINT
+    TEST_CHECK(bitlist.count() == 70);                           // NOLINT
+}
+
+void test_bitvector() {
+    std::mt19937_64 gen{3};  // NOLINT
+    check_bitvector<1>(gen);
+    check_bitvector<4>(gen);    // NOLINT
+    check_bitvector<64>(gen);   // NOLINT
+    check_bitvector<100>(gen);  // NOLINT
+    check_bitvector<512>(gen);  // NOLINT
+
+    eth::Bitvector<4> justification{std::array<bool, 4>{true, true, false, true}};  // NOLINT
+    justification <<= 1;
+    TEST_CHECK(justification.serialize() == std::vector<std::uint8_t>{0b0110});  // NOLINT
+    TEST_CHECK(!justification.test(0) && justification.test(1) && !justification.test(3));  // NOLINT
+    TEST_CHECK(justification.count() == 2 && !justification.all());                        // NOLINT
+}
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+TEST_LIST = {{"bitlist_encoding", test_bitlist_encoding},
+             {"bitlist_operations", test_bitlist_operations},
+             {"bitvector", test_bitvector},
+             {NULL, NULL}};
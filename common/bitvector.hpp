@@ -21,43 +21,129 @@
  */
 
 #pragma once
+#include <algorithm>
 #include <array>
-#include <cassert>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <span>
 
 #include "common/bytes.hpp"
+#include "ssz/hashtree.hpp"
 #include "ssz/ssz.hpp"
 #include "ssz/ssz_container.hpp"
 #include "yaml-cpp/yaml.h"
 
 namespace eth {
+/**
+ *   \brief A vector of N bits packed in 64 bit words.
+ *   \details Bit i is bit i % 64 of word i / 64 and the bits past N are always zero, so that on little endian machines
+ *   the first ssz_size bytes of the words are the SSZ encoding. Shifts move the bits as on the integer of that
+ *   encoding: v <<= 1 moves bit i to bit i + 1, as the justification bits are shifted on each epoch.
+ */
 template <unsigned N>
 class Bitvector : public ssz::Container {
    private:
-    std::array<bool, N> m_arr;
+    static constexpr std::size_t WORD_BITS = 64;
+    static constexpr std::size_t WORDS = (N + WORD_BITS - 1) / WORD_BITS;
+    static constexpr std::uint64_t LAST_WORD_MASK =
+        N % WORD_BITS ? (std::uint64_t{1} << (N % WORD_BITS)) - 1 : ~std::uint64_t{0};
+
+    std::array<std::uint64_t, WORDS> words_{};
+
+    // Clears the bits past N
+    constexpr void trim() {
+        if constexpr (WORDS > 0) words_.back() &= LAST_WORD_MASK;
+    }
+
+   protected:
+    std::vector<ssz::Chunk> hash_tree() const override {
+        SSZ_TRACE_SCOPE("hash_tree");
+        ssz::Merkleizer merkleizer{};
+        if constexpr (std::endian::native == std::endian::little)
+            merkleizer.pack({reinterpret_cast<const std::uint8_t *>(words_.data()), ssz_size});  // NOLINT
+        else
+            merkleizer.pack(this->serialize());
+        return {merkleizer.hash_tree_root()};
+    }
 
    public:
     static constexpr std::size_t ssz_size = (N + constants::BITS_PER_BYTE - 1) / constants::BITS_PER_BYTE;
     std::size_t get_ssz_size() const override { return ssz_size; }
 
     Bitvector() = default;
-    explicit constexpr Bitvector(std::array<bool, N> vec) : m_arr{vec} {};
+    explicit constexpr Bitvector(std::array<bool, N> vec) {
+        for (std::size_t i = 0; i < N; ++i) set(i, vec[i]);
+    };
+
+    static constexpr std::size_t size() { return N; }
+    constexpr bool test(std::size_t index) const { return (words_[index / WORD_BITS] >> (index % WORD_BITS)) & 1U; }
+    constexpr void set(std::size_t index, bool value = true) {
+        const auto mask = std::uint64_t{1} << (index % WORD_BITS);
+        words_[index / WORD_BITS] = value ? words_[index / WORD_BITS] | mask : words_[index / WORD_BITS] & ~mask;
+    }
+    std::span<const std::uint64_t> words() const { return words_; }
+
+    // Number of bits set
+    constexpr std::size_t count() const {
+        std::size_t ret = 0;
+        for (auto word : words_) ret += std::popcount(word);
+        return ret;
+    }
+    constexpr bool none() const { return count() == 0; }
+    constexpr bool all() const { return count() == N; }
+
+    constexpr Bitvector &operator|=(const Bitvector &other) {
+        for (std::size_t i = 0; i < WORDS; ++i) words_[i] |= other.words_[i];
+        return *this;
+    }
+    constexpr Bitvector &operator&=(const Bitvector &other) {
+        for (std::size_t i = 0; i < WORDS; ++i) words_[i] &= other.words_[i];
+        return *this;
+    }
+
+    // Moves bit i to bit i + shift, the bits shifted past N are dropped
+    constexpr Bitvector &operator<<=(std::size_t shift) {
+        const auto word_shift = shift / WORD_BITS, bit_shift = shift % WORD_BITS;
+        for (std::size_t i = WORDS; i-- > 0;) {
+            std::uint64_t word = 0;
+            if (i >= word_shift) {
+                word = words_[i - word_shift] << bit_shift;
+                if (bit_shift && i > word_shift) word |= words_[i - word_shift - 1] >> (WORD_BITS - bit_shift);
+            }
+            words_[i] = word;
+        }
+        trim();
+        return *this;
+    }
+    // Moves bit i to bit i - shift, the lowest shift bits are dropped
+    constexpr Bitvector &operator>>=(std::size_t shift) {
+        const auto word_shift = shift / WORD_BITS, bit_shift = shift % WORD_BITS;
+        for (std::size_t i = 0; i < WORDS; ++i) {
+            std::uint64_t word = 0;
+            if (word_shift < WORDS - i) {
+                word = words_[i + word_shift] >> bit_shift;
+                if (bit_shift && word_shift + 1 < WORDS - i)
+                    word |= words_[i + word_shift + 1] << (WORD_BITS - bit_shift);
+            }
+            words_[i] = word;
+        }
+        return *this;
+    }
 
     void from_hexstring(const std::string &str) {
         if (!str.starts_with("0x")) throw std::invalid_argument("string not prepended with 0x");
         if (str.length() % 2 != 0) throw std::invalid_argument("string of odd length");
 
-        std::uint8_t buffer = 0;
-        std::vector<std::uint8_t> hex;
-        for (int offset = 2; offset < str.length(); offset += 2) {
-            buffer = (helpers::hextoint(str[offset]) << 4) + helpers::hextoint(str[offset + 1]);
-            hex.push_back(buffer);
+        words_.fill(0);
+        for (std::size_t offset = 2, i = 0; offset < str.length() && i < ssz_size; offset += 2, ++i) {
+            std::uint64_t byte = (helpers::hextoint(str[offset]) << 4) + helpers::hextoint(str[offset + 1]);
+            words_[i / sizeof(std::uint64_t)] |= byte << (constants::BITS_PER_BYTE * (i % sizeof(std::uint64_t)));
         }
-        m_arr.fill(0);
-        for (int i = 0; i < hex.size(); ++i)
-            for (int j = 0; j < constants::BITS_PER_BYTE && constants::BITS_PER_BYTE * i + j < N; ++j)
-                m_arr[constants::BITS_PER_BYTE * i + j] = ((hex[i] >> j) & 1);
+        trim();
     }
 
     std::string to_string() const {
@@ -66,26 +152,40 @@ class Bitvector : public ssz::Container {
         auto serial = this->serialize();
         os << "0x";
         for (auto i = serial.cbegin(); i != serial.cend(); ++i)
-            os << std::setfill('0') << std::setw(2) << std::hex << *i;
+            os << std::setfill('0') << std::setw(2) << std::hex << unsigned(*i);
         std::cout.flags(save);
         return os.str();
     };
 
     friend std::ostream &operator<<(std::ostream &os, const Bitvector<N> &m_bits) {
-        for (auto const &b : m_bits.m_arr) os << b;
+        for (std::size_t i = 0; i < N; ++i) os << m_bits.test(i);
         return os;
     };
-    std::vector<std::uint8_t> serialize() const override {
-        Bytes<(N + constants::BITS_PER_BYTE - 1) / constants::BITS_PER_BYTE> ret{};
-        for (int i = 0; i < N; ++i) ret[i / constants::BITS_PER_BYTE] |= m_arr[i] << (i % constants::BITS_PER_BYTE);
-        return ret;
+    std::size_t serialize_into(std::span<std::uint8_t> out) const override {
+        SSZ_TRACE_SCOPE("serialize_into");
+        if (out.size() < ssz_size) throw std::out_of_range("buffer too small for SSZ encoding");
+        if constexpr (std::endian::native == std::endian::little)
+            std::memcpy(out.data(), words_.data(), ssz_size);
+        else
+            for (std::size_t i = 0; i < ssz_size; ++i)
+                out[i] = std::uint8_t(words_[i / sizeof(std::uint64_t)] >>
+                                      (constants::BITS_PER_BYTE * (i % sizeof(std::uint64_t))));
+        return ssz_size;
     }
+    // The encoding has exactly ssz_size bytes and the padding bits past N are zero
     bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        if (std::distance(it, end) != (N + constants::BITS_PER_BYTE - 1) / constants::BITS_PER_BYTE) return false;
-        for (auto i = it; i != end; ++i)
-            for (int j = 0; j < constants::BITS_PER_BYTE && constants::BITS_PER_BYTE * std::distance(it, i) + j < N;
-                 ++j)
-                m_arr[constants::BITS_PER_BYTE * std::distance(it, i) + j] = *i & (1 << j);
+        SSZ_TRACE_SCOPE("deserialize");
+        if (std::distance(it, end) != ssz_size) return false;
+        std::array<std::uint64_t, WORDS> words{};
+        if constexpr (std::endian::native == std::endian::little)
+            std::copy(it, end, reinterpret_cast<std::uint8_t *>(words.data()));  // NOLINT
+        else
+            for (std::size_t i = 0; i < ssz_size; ++i, ++it)
+                words[i / sizeof(std::uint64_t)] |= std::uint64_t{*it}
+                                                    << (constants::BITS_PER_BYTE * (i % sizeof(std::uint64_t)));
+        if constexpr (WORDS > 0)
+            if (words.back() & ~LAST_WORD_MASK) return false;
+        words_ = words;
         return true;
     }
     bool operator==(const Bitvector &) const = default;
@@ -38,7 +38,9 @@ class Boolean : public ssz::Container {
     operator bool() const { return value_; };
     operator bool &() { return value_; }
     operator Bytes1() const { return Bytes1{std::uint8_t(value_)}; }
-    std::vector<std::uint8_t> serialize() const override { return Bytes1(value_).serialize(); }
+    std::size_t serialize_into(std::span<std::uint8_t> out) const override {
+        return Bytes1(value_).serialize_into(out);
+    }
     bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
         if (std::distance(it, end) != 1) return false;
         auto muint = helpers::to_integer_little_endian<std::uint8_t>(&*it);
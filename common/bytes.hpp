@@ -27,6 +27,7 @@
 #include <cstddef>
 #include <cstring>
 #include <iostream>
+#include <span>
 #include <stdexcept>
 #include <vector>
 
@@ -75,9 +76,10 @@ class Bytes : public ssz::Container {
     explicit constexpr Bytes(std::array<std::uint8_t, N> arr) : m_arr{arr} {};
     constexpr ~Bytes() = default;
 
-    std::vector<std::uint8_t> serialize() const override {
-        std::vector<std::uint8_t> ret(m_arr.cbegin(), m_arr.cend());
-        return ret;
+    std::size_t serialize_into(std::span<std::uint8_t> out) const override {
+        if (out.size() < N) throw std::out_of_range("buffer too small for SSZ encoding");
+        std::copy(m_arr.cbegin(), m_arr.cend(), out.begin());
+        return N;
     }
 
     bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
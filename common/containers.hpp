@@ -20,13 +20,23 @@
  */
 
 #pragma once
+#include <algorithm>
+#include <bit>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <iterator>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "common/slot.hpp"
+#include "ssz/arena.hpp"
 #include "ssz/hashtree.hpp"
+#include "ssz/schema.hpp"
 #include "ssz/ssz.hpp"
 #include "ssz/ssz_container.hpp"
 #include "yaml-cpp/yaml.h"
@@ -37,168 +47,503 @@ namespace eth
 template <class T>
 concept BasicObject = std::unsigned_integral<T> || std::is_same_v<T, Slot>;
 
+// Lists and vectors of basic types and byte vectors store the plain values below, whose memory image on little
+// endian machines is their SSZ encoding, so that they are serialized, deserialized and packed with a single copy
+template <class T>
+struct packed {
+    using type = T;
+};
+template <>
+struct packed<Slot> {
+    using type = std::uint64_t;
+};
+template <std::size_t N>
+struct packed<Bytes<N>> {
+    using type = std::array<std::uint8_t, N>;
+};
+template <class T>
+using packed_t = typename packed<T>::type;
+
+template <class T>
+concept PackedObject = !std::is_same_v<packed_t<T>, T> && sizeof(packed_t<T>) == T::ssz_size;
+
+template <class T>
+constexpr packed_t<T> to_packed(const T &value) {
+    if constexpr (!PackedObject<T>)
+        return value;
+    else if constexpr (BasicObject<T>)
+        return std::uint64_t(value);
+    else
+        return value.to_array();
+}
+
+template <class T>
+constexpr T from_packed(const packed_t<T> &value) {
+    if constexpr (!PackedObject<T>)
+        return value;
+    else
+        return T{value};
+}
+
+// A packed element as an lvalue of T: it converts to T and assigning a T packs it
+template <class T>
+class packed_reference {
+   private:
+    packed_t<T> *value_;
+
+   public:
+    constexpr explicit packed_reference(packed_t<T> *value) : value_{value} {}
+    constexpr packed_reference(const packed_reference &) = default;
+    constexpr ~packed_reference() = default;
+
+    constexpr operator T() const { return from_packed<T>(*value_); }
+    constexpr const packed_reference &operator=(const T &value) const {
+        *value_ = to_packed(value);
+        return *this;
+    }
+    constexpr const packed_reference &operator=(const packed_reference &other) const {
+        *value_ = *other.value_;
+        return *this;
+    }
+};
+
+// Iterates over packed storage as elements of type T, by value when Const and through packed_reference otherwise
+template <class T, bool Const>
+class packed_iterator {
+   private:
+    using storage_type = std::conditional_t<Const, const packed_t<T>, packed_t<T>>;
+    storage_type *it_ = nullptr;
+
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, T, packed_reference<T>>;
+    using pointer = void;
+
+    constexpr packed_iterator() = default;
+    constexpr explicit packed_iterator(storage_type *it) : it_{it} {}
+    constexpr operator packed_iterator<T, true>() const requires(!Const) { return packed_iterator<T, true>{it_}; }
+
+    constexpr reference operator*() const {
+        if constexpr (Const)
+            return from_packed<T>(*it_);
+        else
+            return packed_reference<T>{it_};
+    }
+    constexpr reference operator[](difference_type n) const { return *(*this + n); }
+
+    constexpr packed_iterator &operator++() {
+        ++it_;
+        return *this;
+    }
+    constexpr packed_iterator operator++(int) { return packed_iterator{it_++}; }
+    constexpr packed_iterator &operator--() {
+        --it_;
+        return *this;
+    }
+    constexpr packed_iterator operator--(int) { return packed_iterator{it_--}; }
+    constexpr packed_iterator &operator+=(difference_type n) {
+        it_ += n;
+        return *this;
+    }
+    constexpr packed_iterator &operator-=(difference_type n) {
+        it_ -= n;
+        return *this;
+    }
+
+    friend constexpr packed_iterator operator+(packed_iterator it, difference_type n) { return it += n; }
+    friend constexpr packed_iterator operator+(difference_type n, packed_iterator it) { return it += n; }
+    friend constexpr packed_iterator operator-(packed_iterator it, difference_type n) { return it -= n; }
+    friend constexpr difference_type operator-(const packed_iterator &a, const packed_iterator &b) {
+        return a.it_ - b.it_;
+    }
+    friend constexpr auto operator<=>(const packed_iterator &, const packed_iterator &) = default;
+};
+
+// An iterator to the element at index of storage, as T: packed elements go through packed_iterator
+template <class T, class Storage>
+constexpr auto element_iterator(Storage &storage, std::size_t index) noexcept {
+    if constexpr (PackedObject<T>)
+        return packed_iterator<T, std::is_const_v<Storage>>{storage.data() + index};
+    else
+        return storage.begin() + std::ptrdiff_t(index);
+}
+
+template <PackedObject T>
+void serialize_packed(const packed_t<T> *first, std::size_t count, std::uint8_t *out) {
+    std::memcpy(out, first, count * T::ssz_size);
+    if constexpr (std::is_integral_v<packed_t<T>> && std::endian::native == std::endian::big)
+        for (auto *it = out; it != out + count * T::ssz_size; it += T::ssz_size) std::reverse(it, it + T::ssz_size);
+}
+
+template <PackedObject T>
+void deserialize_packed(const std::uint8_t *in, std::size_t count, packed_t<T> *out) {
+    std::memcpy(out, in, count * T::ssz_size);
+    if constexpr (std::is_integral_v<packed_t<T>> && std::endian::native == std::endian::big)
+        for (auto &value : std::span(out, count)) {
+            auto *bytes = reinterpret_cast<std::uint8_t *>(&value);  // NOLINT
+            std::reverse(bytes, bytes + T::ssz_size);
+        }
+}
+
+// The root of a single composite element, byte vectors of chunk size are their own root
+template <class T>
+ssz::Chunk element_root(const packed_t<T> &value) {
+    if constexpr (std::is_same_v<packed_t<T>, ssz::Chunk>)
+        return value;
+    else if constexpr (PackedObject<T>)
+        return from_packed<T>(value).hash_tree_root();
+    else
+        return value.hash_tree_root();
+}
+
+// The roots of count composite elements starting at first, batched across the elements by ssz::hash_tree_roots
+template <class T>
+void element_roots(const packed_t<T> *first, std::size_t count, ssz::Chunk *out) {
+    if constexpr (std::is_same_v<packed_t<T>, ssz::Chunk>)
+        std::copy_n(first, count, out);
+    else if constexpr (PackedObject<T>)
+        ssz::hash_tree_roots<T>(count, [first](std::size_t i) { return from_packed<T>(first[i]); }, out);  // NOLINT
+    else
+        ssz::hash_tree_roots<T>(count, [first](std::size_t i) -> const T & { return first[i]; }, out);  // NOLINT
+}
+
+template <class T>
+void push_element_roots(ssz::Merkleizer &merkleizer, const packed_t<T> *first, std::size_t count) {
+    if constexpr (std::is_same_v<packed_t<T>, ssz::Chunk>)
+        merkleizer.append({first, count});
+    else {
+        std::vector<ssz::Chunk> roots(count);
+        element_roots<T>(first, count, roots.data());
+        merkleizer.append(roots);
+    }
+}
+
 template <class T, std::size_t N>
 class VectorFixedSizedParts : public ssz::Container {
    private:
-    std::array<T, N> m_arr;
+    std::array<packed_t<T>, N> m_arr{};
 
    protected:
-    std::vector<ssz::Chunk> hash_tree_x() const requires BasicObject<T> { return ssz::Container::hash_tree(); }
+    std::vector<ssz::Chunk> hash_tree_x() const requires BasicObject<T> {
+        ssz::Merkleizer merkleizer{};
+        if constexpr (std::endian::native == std::endian::little)
+            merkleizer.pack({reinterpret_cast<const std::uint8_t *>(m_arr.data()), ssz_size});  // NOLINT
+        else
+            merkleizer.pack(this->serialize());
+        return {merkleizer.hash_tree_root()};
+    }
 
     std::vector<ssz::Chunk> hash_tree_x() const requires(!BasicObject<T>) {
-        std::vector<ssz::Chunk> chunks{};
-        chunks.reserve(m_arr.size());
-        for (auto &part : m_arr) chunks.push_back(part.hash_tree_root());
-        // return early if only one chunk
-        if (N == 1) return chunks;
-
-        ssz::HashTree ht{chunks};
-        return ht.hash_tree();
+        ssz::Merkleizer merkleizer{};
+        push_element_roots<T>(merkleizer, m_arr.data(), N);
+        return {merkleizer.hash_tree_root()};
     }
 
     std::vector<ssz::Chunk> hash_tree() const override { return hash_tree_x(); }
 
    public:
+    using value_type = T;
     static constexpr std::size_t ssz_size = N * T::ssz_size;
     std::size_t get_ssz_size() const override { return ssz_size; }
 
+    using iterator = decltype(element_iterator<T>(std::declval<std::array<packed_t<T>, N> &>(), 0));
+    using const_iterator = decltype(element_iterator<T>(std::declval<const std::array<packed_t<T>, N> &>(), 0));
+
     static std::size_t size(void) { return N; }
 
-    constexpr typename std::array<T, N>::iterator begin() noexcept { return m_arr.begin(); }
+    constexpr iterator begin() noexcept { return element_iterator<T>(m_arr, 0); }
 
-    constexpr typename std::array<T, N>::const_iterator cbegin() const noexcept { return m_arr.cbegin(); }
+    constexpr const_iterator cbegin() const noexcept { return element_iterator<T>(m_arr, 0); }
 
-    constexpr typename std::array<T, N>::iterator end() noexcept { return m_arr.end(); }
+    constexpr iterator end() noexcept { return element_iterator<T>(m_arr, N); }
 
-    constexpr typename std::array<T, N>::const_iterator cend() const noexcept { return m_arr.cend(); }
+    constexpr const_iterator cend() const noexcept { return element_iterator<T>(m_arr, N); }
 
-    BytesVector serialize() const override {
-        BytesVector ret;
-        for (auto part : m_arr) {
-            auto part_ssz = part.serialize();
-            ret.insert(ret.end(), part_ssz.begin(), part_ssz.end());
-        }
-        return ret;
+    constexpr decltype(auto) operator[](std::size_t index) { return begin()[std::ptrdiff_t(index)]; }
+    constexpr decltype(auto) operator[](std::size_t index) const { return cbegin()[std::ptrdiff_t(index)]; }
+
+    std::size_t serialize_into(std::span<std::uint8_t> out) const override {
+        SSZ_TRACE_SCOPE("serialize_into");
+        if (out.size() < ssz_size) throw std::out_of_range("buffer too small for SSZ encoding");
+        if constexpr (PackedObject<T>)
+            serialize_packed<T>(m_arr.data(), N, out.data());
+        else
+            for (std::size_t i = 0; i < N; ++i) m_arr[i].serialize_into(out.subspan(i * T::ssz_size));
+        return ssz_size;
     }
 
     bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
+        SSZ_TRACE_SCOPE("deserialize");
         if (std::distance(it, end) != ssz_size) return false;
 
-        for (int i = 0; i < N; ++i)
-            if (!m_arr[i].deserialize(it + i * T::ssz_size, it + (i + 1) * T::ssz_size)) return false;
+        if constexpr (PackedObject<T>)
+            deserialize_packed<T>(&*it, N, m_arr.data());
+        else
+            for (int i = 0; i < N; ++i)
+                if (!m_arr[i].deserialize(it + i * T::ssz_size, it + (i + 1) * T::ssz_size)) return false;
         return true;
     }
 
-    YAML::Node encode() const override { return YAML::convert<std::array<T, N>>::encode(m_arr); }
-    bool decode(const YAML::Node &node) override { return YAML::convert<std::array<T, N>>::decode(node, m_arr); }
+    YAML::Node encode() const override {
+        std::vector<T> objects(m_arr.cbegin(), m_arr.cend());
+        return YAML::convert<std::vector<T>>::encode(objects);
+    }
+    bool decode(const YAML::Node &node) override {
+        std::vector<T> objects;
+        if (!YAML::convert<std::vector<T>>::decode(node, objects) || objects.size() != N) return false;
+        std::transform(objects.cbegin(), objects.cend(), m_arr.begin(), to_packed<T>);
+        return true;
+    }
 };
 
 template <class T>
 class ListFixedSizedParts : public ssz::Container {
-   private:
-    std::vector<T> m_arr;
+   protected:
+    ssz::vector<packed_t<T>> m_arr;
     std::size_t limit_;
 
    protected:
     std::vector<ssz::Chunk> hash_tree_x() const requires BasicObject<T> {
-        auto ser = this->serialize();
         auto limit = (limit_ * T::ssz_size + constants::BYTES_PER_CHUNK - 1) / constants::BYTES_PER_CHUNK;
-        ssz::HashTree ht{ser, limit};
-        ht.mix_in(m_arr.size());
-        return ht.hash_tree();
+        ssz::Merkleizer merkleizer{limit};
+        if constexpr (std::endian::native == std::endian::little)
+            merkleizer.pack({reinterpret_cast<const std::uint8_t *>(m_arr.data()), serialized_size()});  // NOLINT
+        else
+            merkleizer.pack(this->serialize());
+        return {merkleizer.hash_tree_root(m_arr.size())};
     }
     std::vector<ssz::Chunk> hash_tree_x() const requires(!BasicObject<T>) {
-        std::vector<ssz::Chunk> chunks{};
-        chunks.reserve(m_arr.size());
-        for (auto &part : m_arr) chunks.push_back(part.hash_tree_root());
-        if (chunks.empty()) {
-            ssz::Chunk chunk{};
-            chunks.push_back(chunk);
-        }
-        ssz::HashTree ht{chunks, limit_};
-        ht.mix_in(m_arr.size());
-        return ht.hash_tree();
+        ssz::Merkleizer merkleizer{limit_};
+        push_element_roots<T>(merkleizer, m_arr.data(), m_arr.size());
+        return {merkleizer.hash_tree_root(m_arr.size())};
     }
     std::vector<ssz::Chunk> hash_tree() const override { return hash_tree_x(); }
 
    public:
+    using value_type = T;
+    using iterator = decltype(element_iterator<T>(std::declval<ssz::vector<packed_t<T>> &>(), 0));
+    using const_iterator = decltype(element_iterator<T>(std::declval<const ssz::vector<packed_t<T>> &>(), 0));
+
     ListFixedSizedParts(std::size_t limit = 0) : limit_{limit} {};
     std::size_t size(void) const { return m_arr.size(); }
 
-    constexpr typename std::vector<T>::iterator begin() noexcept { return m_arr.begin(); }
-    constexpr typename std::vector<T>::const_iterator cbegin() const noexcept { return m_arr.cbegin(); }
-    constexpr typename std::vector<T>::iterator end() noexcept { return m_arr.end(); }
-    constexpr typename std::vector<T>::const_iterator cend() const noexcept { return m_arr.cend(); }
-    std::vector<T>& data() { return m_arr; }
-
+    constexpr iterator begin() noexcept { return element_iterator<T>(m_arr, 0); }
+    constexpr const_iterator cbegin() const noexcept { return element_iterator<T>(m_arr, 0); }
+    constexpr iterator end() noexcept { return element_iterator<T>(m_arr, m_arr.size()); }
+    constexpr const_iterator cend() const noexcept { return element_iterator<T>(m_arr, m_arr.size()); }
+    decltype(auto) operator[](std::size_t index) { return begin()[std::ptrdiff_t(index)]; }
+    decltype(auto) operator[](std::size_t index) const { return cbegin()[std::ptrdiff_t(index)]; }
+    void push_back(const T &value) { m_arr.push_back(to_packed(value)); }
+    void resize(std::size_t count) { m_arr.resize(count); }
+    // Packed elements are only reachable through the accessors above
+    ssz::vector<T> &data() requires(!PackedObject<T>) { return m_arr; }
+
+    std::size_t limit() const { return limit_; }
     void limit(std::size_t limit) { limit_ = limit; }
 
-    BytesVector serialize() const override {
-        BytesVector ret;
-        for (auto part : m_arr) {
-            auto part_ssz = part.serialize();
-            ret.insert(ret.end(), part_ssz.begin(), part_ssz.end());
-        }
-        return ret;
+    std::size_t serialized_size() const override { return m_arr.size() * T::ssz_size; }
+    std::size_t serialize_into(std::span<std::uint8_t> out) const override {
+        SSZ_TRACE_SCOPE("serialize_into");
+        if (out.size() < serialized_size()) throw std::out_of_range("buffer too small for SSZ encoding");
+        if constexpr (PackedObject<T>)
+            serialize_packed<T>(m_arr.data(), m_arr.size(), out.data());
+        else
+            for (std::size_t i = 0; i < m_arr.size(); ++i) m_arr[i].serialize_into(out.subspan(i * T::ssz_size));
+        return serialized_size();
     }
 
     bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
+        SSZ_TRACE_SCOPE("deserialize");
         m_arr.clear();
-        if (std::distance(it, end) % T::ssz_size) return false;
+        m_arr.reserve(std::distance(it, end) / T::ssz_size);
+        return deserialize_append(it, end);
+    }
 
-        for (auto i = it; i != end; i += T::ssz_size) {
-            T obj;
-            if (!obj.deserialize(i, i + T::ssz_size)) return false;
-            m_arr.push_back(obj);
-        }
+    // Decodes the elements in [it, end) after the current ones, to decode the list a piece at a time
+    void reserve(std::size_t count) { m_arr.reserve(count); }
+    bool deserialize_append(ssz::SSZIterator it, ssz::SSZIterator end) {
+        if (std::distance(it, end) % T::ssz_size) return false;
+        const auto first = m_arr.size(), count = std::size_t(std::distance(it, end)) / T::ssz_size;
+        if constexpr (PackedObject<T>) {
+            m_arr.resize(first + count);
+            if (count) deserialize_packed<T>(&*it, count, m_arr.data() + first);
+        } else
+            for (auto i = it; i != end; i += T::ssz_size)
+                if (!m_arr.emplace_back().deserialize(i, i + T::ssz_size)) return false;
+        return true;
+    }
+    YAML::Node encode() const override {
+        std::vector<T> objects(m_arr.cbegin(), m_arr.cend());
+        return YAML::convert<std::vector<T>>::encode(objects);
+    }
+    bool decode(const YAML::Node &node) override {
+        std::vector<T> objects;
+        if (!YAML::convert<std::vector<T>>::decode(node, objects)) return false;
+        m_arr.resize(objects.size());
+        std::transform(objects.cbegin(), objects.cend(), m_arr.begin(), to_packed<T>);
         return true;
     }
-    YAML::Node encode() const override { return YAML::convert<std::vector<T>>::encode(m_arr); }
-    bool decode(const YAML::Node &node) override { return YAML::convert<std::vector<T>>::decode(node, m_arr); }
+};
+
+// A list that keeps the Merkle tree of its elements between calls to hash_tree_root(). Elements modified through
+// set() and push_back() are tracked so that only their paths are rehashed, any other mutable access to the
+// underlying vector invalidates the whole cache. The cache is locked, the root of a const list can be computed from
+// several threads at once.
+template <class T>
+class CachedListFixedSizedParts : public ListFixedSizedParts<T> {
+   private:
+    ssz::ListTreeCache cache_;
+
+    // Leaves are computed in blocks of this size, concurrently when HashTree has a thread pool
+    static constexpr std::size_t LEAVES_PER_TASK = 256;
+
+    static constexpr std::size_t elements_per_chunk() {
+        if constexpr (BasicObject<T>)
+            return constants::BYTES_PER_CHUNK / T::ssz_size;
+        else
+            return 1;
+    }
+    static constexpr std::uint64_t chunk_limit(std::size_t limit) {
+        return (limit + elements_per_chunk() - 1) / elements_per_chunk();
+    }
+    std::size_t chunk_count() const { return chunk_limit(this->m_arr.size()); }
+
+    ssz::Chunk leaf(std::size_t index) const {
+        if constexpr (BasicObject<T>) {
+            ssz::Chunk chunk{};
+            auto first = index * elements_per_chunk();
+            auto count = std::min(elements_per_chunk(), this->m_arr.size() - first);
+            serialize_packed<T>(this->m_arr.data() + first, count, chunk.data());
+            return chunk;
+        } else
+            return element_root<T>(this->m_arr[index]);
+    }
+
+   protected:
+    std::vector<ssz::Chunk> hash_tree() const override {
+        auto all_leaves = [this] {
+            std::vector<ssz::Chunk> leaves(chunk_count());
+            auto compute_leaves = [&](std::size_t block) {
+                auto first = block * LEAVES_PER_TASK;
+                auto last = std::min(first + LEAVES_PER_TASK, leaves.size());
+                if constexpr (BasicObject<T>)
+                    for (auto i = first; i < last; ++i) leaves[i] = leaf(i);
+                else
+                    element_roots<T>(this->m_arr.data() + first, last - first, leaves.data() + first);
+            };
+            auto blocks = (leaves.size() + LEAVES_PER_TASK - 1) / LEAVES_PER_TASK;
+            if (auto *pool = ssz::HashTree::thread_pool())
+                pool->parallel_for(blocks, compute_leaves);
+            else
+                for (std::size_t block = 0; block < blocks; ++block) compute_leaves(block);
+            return leaves;
+        };
+        auto changed_leaves = [this](const std::vector<std::size_t> &indices) {
+            std::vector<ssz::Chunk> leaves(indices.size());
+            std::transform(indices.cbegin(), indices.cend(), leaves.begin(), [this](auto i) { return leaf(i); });
+            return leaves;
+        };
+        return {cache_.hash_tree_root(chunk_count(), this->m_arr.size(), elements_per_chunk(), all_leaves,
+                                      changed_leaves)};
+    }
+
+   public:
+    CachedListFixedSizedParts(std::size_t limit = 0) : ListFixedSizedParts<T>{limit}, cache_{chunk_limit(limit)} {};
+
+    using ListFixedSizedParts<T>::limit;
+    void limit(std::size_t limit) {
+        this->limit_ = limit;
+        cache_.limit(chunk_limit(limit));
+    }
+
+    // Packed elements are returned by value, changes go through set()
+    decltype(auto) operator[](std::size_t index) const { return ListFixedSizedParts<T>::operator[](index); }
+    void set(std::size_t index, const T &value) {
+        this->m_arr[index] = to_packed(value);
+        cache_.changed(index);
+    }
+    void push_back(const T &value) {
+        cache_.changed(this->m_arr.size());
+        this->m_arr.push_back(to_packed(value));
+    }
+
+    void resize(std::size_t count) {
+        cache_.invalidate();
+        this->m_arr.resize(count);
+    }
+
+    typename ListFixedSizedParts<T>::iterator begin() noexcept {
+        cache_.invalidate();
+        return ListFixedSizedParts<T>::begin();
+    }
+    typename ListFixedSizedParts<T>::iterator end() noexcept {
+        cache_.invalidate();
+        return ListFixedSizedParts<T>::end();
+    }
+    ssz::vector<T> &data() requires(!PackedObject<T>) {
+        cache_.invalidate();
+        return this->m_arr;
+    }
+
+    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
+        cache_.invalidate();
+        return ListFixedSizedParts<T>::deserialize(it, end);
+    }
+    bool deserialize_append(ssz::SSZIterator it, ssz::SSZIterator end) {
+        cache_.invalidate();
+        return ListFixedSizedParts<T>::deserialize_append(it, end);
+    }
+    bool decode(const YAML::Node &node) override {
+        cache_.invalidate();
+        return ListFixedSizedParts<T>::decode(node);
+    }
 };
 
 template <class T>
 class ListVariableSizedParts : public ssz::Container {
    private:
-    std::vector<T> m_arr;
+    ssz::vector<T> m_arr;
     std::size_t limit_;
 
    public:
+    using value_type = T;
     ListVariableSizedParts(std::size_t limit = 0) : limit_{limit} {};
 
     std::size_t size(void) const { return m_arr.size(); }
-    constexpr typename std::vector<T>::iterator begin() noexcept { return m_arr.begin(); }
-    constexpr typename std::vector<T>::const_iterator cbegin() const noexcept { return m_arr.cbegin(); }
-    constexpr typename std::vector<T>::iterator end() noexcept { return m_arr.end(); }
-    constexpr typename std::vector<T>::const_iterator cend() const noexcept { return m_arr.cend(); }
+    std::size_t limit() const { return limit_; }
+    void limit(std::size_t limit) { limit_ = limit; }
+    constexpr typename ssz::vector<T>::iterator begin() noexcept { return m_arr.begin(); }
+    constexpr typename ssz::vector<T>::const_iterator cbegin() const noexcept { return m_arr.cbegin(); }
+    constexpr typename ssz::vector<T>::iterator end() noexcept { return m_arr.end(); }
+    constexpr typename ssz::vector<T>::const_iterator cend() const noexcept { return m_arr.cend(); }
+    ssz::vector<T> &data() { return m_arr; }
     std::vector<ssz::Chunk> hash_tree() const override {
-        std::vector<ssz::Chunk> chunks{};
-        chunks.reserve(m_arr.size());
-        std::transform(m_arr.begin(), m_arr.end(), std::back_inserter(chunks),
-                       [](const T &part) { return part.hash_tree_root(); });
-        if (chunks.empty()) {
-            ssz::Chunk chunk{};
-            chunks.push_back(chunk);
-        }
-        ssz::HashTree ht{chunks, limit_};
-        ht.mix_in(m_arr.size());
-        return ht.hash_tree();
+        std::vector<ssz::Chunk> roots(m_arr.size());
+        ssz::hash_tree_roots<T>(m_arr.size(), [this](std::size_t i) -> const T & { return m_arr[i]; }, roots.data());
+        ssz::Merkleizer merkleizer{limit_};
+        for (const auto &root : roots) merkleizer.push_back(root);
+        return {merkleizer.hash_tree_root(m_arr.size())};
     }
-    BytesVector serialize() const override {
-        BytesVector offsets, ret;
+    std::size_t serialized_size() const override {
+        std::size_t ret = size() * constants::BYTES_PER_LENGTH_OFFSET;
+        for (const auto &part : m_arr) ret += part.serialized_size();
+        return ret;
+    }
+    std::size_t serialize_into(std::span<std::uint8_t> out) const override {
+        SSZ_TRACE_SCOPE("serialize_into");
         std::uint32_t offset = size() * constants::BYTES_PER_LENGTH_OFFSET;
-        for (auto part : m_arr) {
-            auto offset_ssz = Bytes4(offset).serialize();
-            offsets.insert(offsets.end(), offset_ssz.begin(), offset_ssz.end());
-
-            auto part_ssz = part.serialize();
-            offset += part_ssz.size();
-            ret.insert(ret.end(), part_ssz.begin(), part_ssz.end());
+        if (out.size() < offset) throw std::out_of_range("buffer too small for SSZ encoding");
+        for (std::size_t i = 0; i < m_arr.size(); ++i) {
+            Bytes4(offset).serialize_into(out.subspan(i * constants::BYTES_PER_LENGTH_OFFSET));
+            offset += std::uint32_t(m_arr[i].serialize_into(out.subspan(offset)));
         }
-        if (offsets.size()) ret.insert(ret.begin(), offsets.begin(), offsets.end());
-        return ret;
+        return offset;
     }
     bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
+        SSZ_TRACE_SCOPE("deserialize");
         m_arr.clear();
         if (it == end)  // empty list
             return true;
@@ -216,113 +561,67 @@ class ListVariableSizedParts : public ssz::Container {
             auto current_offset = helpers::to_integer_little_endian<std::uint32_t>(&*it);
             if (current_offset < last_offset) return false;
             if (std::distance(start, end) < current_offset) return false;
-            T obj;
-            if (!obj.deserialize(start + last_offset, start + current_offset)) return false;
-            m_arr.push_back(obj);
+            if (!m_arr.emplace_back().deserialize(start + last_offset, start + current_offset)) return false;
             last_offset = current_offset;
             it += constants::BYTES_PER_LENGTH_OFFSET;
         }
-        T obj;
-        if (!obj.deserialize(start + last_offset, end)) return false;
-        m_arr.push_back(obj);
-        return true;
+        return m_arr.emplace_back().deserialize(start + last_offset, end);
     }
 
-    YAML::Node encode() const override { return YAML::convert<std::vector<T>>::encode(m_arr); }
-    bool decode(const YAML::Node &node) override { return YAML::convert<std::vector<T>>::decode(node, m_arr); }
+    YAML::Node encode() const override {
+        std::vector<T> objects(m_arr.cbegin(), m_arr.cend());
+        return YAML::convert<std::vector<T>>::encode(objects);
+    }
+    bool decode(const YAML::Node &node) override {
+        std::vector<T> objects;
+        if (!YAML::convert<std::vector<T>>::decode(node, objects)) return false;
+        m_arr.assign(objects.cbegin(), objects.cend());
+        return true;
+    }
 };
 
-struct Fork : public ssz::Container {
+struct Fork : public ssz::SchemaContainer<Fork> {
     Version previous_version, current_version;
     Epoch epoch;
 
     static constexpr std::size_t ssz_size = 16;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-
-    std::vector<ssz::Chunk> hash_tree() const override {
-        return hash_tree_({&previous_version, &current_version, &epoch});
-    }
-
-    BytesVector serialize() const override { return serialize_({&previous_version, &current_version, &epoch}); }
-
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&previous_version, &current_version, &epoch});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("previous_version", &Fork::previous_version),
+                          ssz::field("current_version", &Fork::current_version), ssz::field("epoch", &Fork::epoch)};
     }
 
     bool operator==(const Fork &) const = default;
-
-    YAML::Node encode() const override {
-        return encode_(
-            {{"previous_version", &previous_version}, {"current_version", &current_version}, {"epoch", &epoch}});
-    }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(
-            node, {{"previous_version", &previous_version}, {"current_version", &current_version}, {"epoch", &epoch}});
-    }
 };
 
-struct ForkData : public ssz::Container {
+struct ForkData : public ssz::SchemaContainer<ForkData> {
     Version current_version;
     Root genesis_validators_root;
 
     static constexpr std::size_t ssz_size = 36;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-
-    std::vector<ssz::Chunk> hash_tree() const override {
-        return hash_tree_({&current_version, &genesis_validators_root});
-    }
-
-    BytesVector serialize() const override { return serialize_({&current_version, &genesis_validators_root}); }
-
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&current_version, &genesis_validators_root});
-    }
-
-    YAML::Node encode() const override {
-        return encode_({{"current_version", &current_version}, {"genesis_validators_root", &genesis_validators_root}});
-    }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(node,
-                       {{"current_version", &current_version}, {"genesis_validators_root", &genesis_validators_root}});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("current_version", &ForkData::current_version),
+                          ssz::field("genesis_validators_root", &ForkData::genesis_validators_root)};
     }
 };
 
-struct Checkpoint : public ssz::Container {
+struct Checkpoint : public ssz::SchemaContainer<Checkpoint> {
     Epoch epoch;
     Root root;
 
     static constexpr std::size_t ssz_size = 40;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-    std::vector<ssz::Chunk> hash_tree() const override { return hash_tree_({&epoch, &root}); }
-    BytesVector serialize() const override { return serialize_({&epoch, &root}); }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&epoch, &root});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("epoch", &Checkpoint::epoch), ssz::field("root", &Checkpoint::root)};
     }
-
-    YAML::Node encode() const override { return encode_({{"epoch", &epoch}, {"root", &root}}); }
-
-    bool decode(const YAML::Node &node) override { return decode_(node, {{"epoch", &epoch}, {"root", &root}}); }
 };
 
-struct SigningData : public ssz::Container {
+struct SigningData : public ssz::SchemaContainer<SigningData> {
     Root object_root;
     Domain domain;
 
     static constexpr std::size_t ssz_size = 64;
-    std::size_t get_ssz_size() const override { return ssz_size; }
-
-    std::vector<ssz::Chunk> hash_tree() const override { return hash_tree_({&object_root, &domain}); }
-    BytesVector serialize() const override { return serialize_({&object_root, &domain}); }
-    bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
-        return deserialize_(it, end, {&object_root, &domain});
-    }
-
-    YAML::Node encode() const override { return encode_({{"object_root", &object_root}, {"domain", &domain}}); }
-
-    bool decode(const YAML::Node &node) override {
-        return decode_(node, {{"object_root", &object_root}, {"domain", &domain}});
+    static constexpr auto fields() {
+        return std::tuple{ssz::field("object_root", &SigningData::object_root),
+                          ssz::field("domain", &SigningData::domain)};
     }
 };
 
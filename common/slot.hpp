@@ -52,7 +52,9 @@ class Slot : public ssz::Container {
         return {chunk};
     }
 
-    std::vector<std::uint8_t> serialize() const override { return Bytes8(value_).serialize(); }
+    std::size_t serialize_into(std::span<std::uint8_t> out) const override {
+        return Bytes8(value_).serialize_into(out);
+    }
     bool deserialize(ssz::SSZIterator it, ssz::SSZIterator end) override {
         if (std::distance(it, end) != sizeof(value_)) return false;
         value_ = helpers::to_integer_little_endian<std::uint64_t>(&*it);
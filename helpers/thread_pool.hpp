@@ -0,0 +1,124 @@
+/*  thread_pool.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace helpers {
+
+/**
+ *   \brief A fixed set of worker threads running tasks from a shared queue.
+ *   \details parallel_for() blocks until its tasks are done, and the waiting thread runs queued tasks meanwhile, so
+ *   it is safe to call it from within a task of the same pool. Those may be any task, so it must not be called while
+ *   holding a lock that other tasks take.
+ */
+class ThreadPool {
+   private:
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+    bool run_one() {
+        std::function<void()> task;
+        {
+            std::lock_guard lock{mutex_};
+            if (queue_.empty()) return false;
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        task();
+        return true;
+    }
+
+    void work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock{mutex_};
+                cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                if (stop_ && queue_.empty()) return;
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            task();
+        }
+    }
+
+   public:
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency()) {
+        workers_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) workers_.emplace_back([this] { work(); });
+    }
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool() {
+        {
+            std::lock_guard lock{mutex_};
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto &worker : workers_) worker.join();
+    }
+
+    std::size_t size() const { return workers_.size(); }
+
+    // Runs task(i) for every i in [0, count) and returns when all of them have finished. If any of them throws, the
+    // first exception is rethrown once all have finished, as the tasks refer to this frame.
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)> &task) {
+        if (count == 0) return;
+        std::atomic<std::size_t> pending{count - 1};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto run = [&](std::size_t i) {
+            try {
+                task(i);
+            } catch (...) {
+                std::lock_guard lock{error_mutex};
+                if (!error) error = std::current_exception();
+            }
+        };
+        {
+            std::lock_guard lock{mutex_};
+            for (std::size_t i = 1; i < count; ++i)
+                queue_.emplace_back([&run, &pending, i] {
+                    run(i);
+                    pending.fetch_sub(1, std::memory_order_release);
+                });
+        }
+        cv_.notify_all();
+        run(0);
+        while (pending.load(std::memory_order_acquire))
+            if (!run_one()) std::this_thread::yield();
+        if (error) std::rethrow_exception(error);
+    }
+};
+}  // namespace helpers
@@ -0,0 +1,142 @@
+/*  arena.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "ssz/ssz_container.hpp"
+
+namespace ssz {
+// Makes resource the one of the lists constructed on this thread while in scope, nullptr is the heap
+class ScopedMemoryResource {
+   private:
+    std::pmr::memory_resource *previous_;
+    inline static thread_local std::pmr::memory_resource *current_ = nullptr;
+
+   public:
+    explicit ScopedMemoryResource(std::pmr::memory_resource *resource) : previous_{current_} { current_ = resource; }
+    ~ScopedMemoryResource() { current_ = previous_; }
+    ScopedMemoryResource(const ScopedMemoryResource &) = delete;
+    ScopedMemoryResource &operator=(const ScopedMemoryResource &) = delete;
+
+    static std::pmr::memory_resource *current() noexcept { return current_; }
+};
+
+/**
+ *   \brief Allocator of the lists of the SSZ types.
+ *   \details It allocates from the memory resource that was current on the thread when it was constructed, see
+ *   ScopedMemoryResource, or from the heap as std::allocator when there was none. A list keeps its resource when it
+ *   is moved, a copy allocates from the current one, so that copying an object out of an arena puts it on the heap.
+ */
+template <class T>
+class Allocator {
+   private:
+    std::pmr::memory_resource *resource_;
+
+    template <class U>
+    friend class Allocator;
+
+   public:
+    using value_type = T;
+
+    Allocator() noexcept : resource_{ScopedMemoryResource::current()} {}
+    template <class U>
+    Allocator(const Allocator<U> &other) noexcept : resource_{other.resource_} {}  // NOLINT
+
+    // nullptr is the heap
+    std::pmr::memory_resource *resource() const noexcept { return resource_; }
+
+    T *allocate(std::size_t n) {
+        if (!resource_) return std::allocator<T>{}.allocate(n);
+        return static_cast<T *>(resource_->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T *p, std::size_t n) noexcept {
+        if (!resource_) return std::allocator<T>{}.deallocate(p, n);
+        resource_->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    Allocator select_on_container_copy_construction() const noexcept { return {}; }
+
+    template <class U>
+    bool operator==(const Allocator<U> &other) const noexcept {
+        return resource_ == other.resource_ || (resource_ && other.resource_ && *resource_ == *other.resource_);
+    }
+};
+
+template <class T>
+using vector = std::vector<T, Allocator<T>>;
+
+/**
+ *   \brief A monotonic buffer that holds whole decoded objects, lists included, and frees them at once.
+ *   \details Meant for short lived objects as gossip blocks and attestations: deserializing into the arena costs a
+ *   few large allocations instead of one for each list. The arena is not thread safe and must outlive the objects
+ *   made in it, their destructors do not free any memory.
+ */
+class Arena {
+   private:
+    std::pmr::monotonic_buffer_resource resource_;
+
+   public:
+    static constexpr std::size_t INITIAL_SIZE = 1U << 16U;
+
+    // Runs the destructor only, the memory goes with the arena
+    struct Destroy {
+        template <class T>
+        void operator()(T *object) const noexcept {
+            object->~T();
+        }
+    };
+    template <class T>
+    using Ptr = std::unique_ptr<T, Destroy>;
+
+    explicit Arena(std::size_t initial_size = INITIAL_SIZE) : resource_{initial_size} {}
+    // Starts on a buffer of the caller, further memory comes from the heap
+    Arena(void *buffer, std::size_t size) : resource_{buffer, size} {}
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    std::pmr::memory_resource *resource() noexcept { return &resource_; }
+    // Frees everything at once, the objects made in the arena must have been destroyed
+    void release() { resource_.release(); }
+
+    template <class T, class... Args>
+    Ptr<T> make(Args &&...args) {
+        ScopedMemoryResource scope{&resource_};
+        void *memory = resource_.allocate(sizeof(T), alignof(T));
+        return Ptr<T>{new (memory) T(std::forward<Args>(args)...)};
+    }
+
+    // A T constructed from args and decoded from [it, end) with all of its lists in the arena, nullptr if the encoding
+    // is invalid
+    template <class T, class... Args>
+    Ptr<T> deserialize(SSZIterator it, SSZIterator end, Args &&...args) {
+        ScopedMemoryResource scope{&resource_};
+        auto ret = make<T>(std::forward<Args>(args)...);
+        if (!ret->deserialize(it, end)) return nullptr;
+        return ret;
+    }
+};
+}  // namespace ssz
@@ -0,0 +1,137 @@
+/*  hash_stats.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ssz/hash_stats.hpp"
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+using ssz::HashStats;
+
+struct Totals {
+    std::uint64_t roots, calls, blocks, nanoseconds;
+};
+
+// The call counters are shared by all threads, the totals by type are only updated when a root is done
+std::atomic<std::uint64_t> calls{0}, blocks{0}, nanoseconds{0}, untracked_blocks{0};  // NOLINT
+std::array<std::atomic<std::uint64_t>, HashStats::BUCKETS> histogram{};             // NOLINT
+std::mutex types_mutex;                                                              // NOLINT
+std::unordered_map<std::type_index, Totals> types;                                   // NOLINT
+
+std::string demangle(const char *name) {
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> demangled{abi::__cxa_demangle(name, nullptr, nullptr, &status),
+                                                          &std::free};
+    return status == 0 ? demangled.get() : name;
+}
+}  // namespace
+
+namespace ssz {
+void HashStats::record_call(std::size_t count, std::chrono::nanoseconds elapsed) {
+    calls.fetch_add(1, std::memory_order_relaxed);
+    blocks.fetch_add(count, std::memory_order_relaxed);
+    nanoseconds.fetch_add(elapsed.count(), std::memory_order_relaxed);
+    auto bucket = std::min<std::size_t>(std::bit_width(std::max<std::size_t>(count, 1)) - 1, BUCKETS - 1);
+    histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    if (scope_) {
+        ++scope_->calls_;
+        scope_->blocks_ += count;
+    } else
+        untracked_blocks.fetch_add(count, std::memory_order_relaxed);
+}
+
+HashStats::TypeScope::TypeScope(std::type_index type)
+    : type_{type}, parent_{scope_}, start_{std::chrono::steady_clock::now()} {
+    scope_ = this;
+}
+
+HashStats::TypeScope::~TypeScope() {
+    auto elapsed = std::chrono::nanoseconds(std::chrono::steady_clock::now() - start_).count();
+    scope_ = parent_;
+    std::lock_guard lock{types_mutex};
+    auto &totals = types[type_];
+    ++totals.roots;
+    totals.calls += calls_;
+    totals.blocks += blocks_;
+    totals.nanoseconds += elapsed;
+}
+
+HashStats::Snapshot HashStats::snapshot() {
+    Snapshot ret;
+    ret.calls = calls.load();
+    ret.blocks = blocks.load();
+    ret.nanoseconds = nanoseconds.load();
+    ret.untracked_blocks = untracked_blocks.load();
+    std::transform(histogram.cbegin(), histogram.cend(), ret.histogram.begin(),
+                   [](const auto &bucket) { return bucket.load(); });
+    {
+        std::lock_guard lock{types_mutex};
+        for (const auto &[type, totals] : types)
+            ret.types.push_back({demangle(type.name()), totals.roots, totals.calls, totals.blocks, totals.nanoseconds});
+    }
+    std::sort(ret.types.begin(), ret.types.end(), [](const auto &a, const auto &b) {
+        return a.blocks > b.blocks || (a.blocks == b.blocks && a.type < b.type);
+    });
+    return ret;
+}
+
+void HashStats::reset() {
+    for (auto *counter : {&calls, &blocks, &nanoseconds, &untracked_blocks}) counter->store(0);
+    for (auto &bucket : histogram) bucket.store(0);
+    std::lock_guard lock{types_mutex};
+    types.clear();
+}
+
+void HashStats::dump(std::ostream &os) {
+    auto stats = snapshot();
+    if (!enabled) {
+        os << "hash statistics are disabled, build with -DHASHER_STATS=ON\n";
+        return;
+    }
+    auto per_call = stats.calls ? double(stats.blocks) / double(stats.calls) : 0;
+    auto per_block = stats.blocks ? double(stats.nanoseconds) / double(stats.blocks) : 0;
+    os << "hash_64b_blocks: " << stats.calls << " calls, " << stats.blocks << " blocks, " << std::setprecision(3)
+       << per_call << " blocks per call, " << per_block << " ns per block\n";
+    os << "Blocks per call     Calls\n";
+    for (std::size_t b = 0; b < BUCKETS; ++b)
+        if (stats.histogram[b])
+            os << std::setw(8) << (std::uint64_t{1} << b) << (b + 1 < BUCKETS ? " - " : "+   ") << std::setw(8)
+               << (b + 1 < BUCKETS ? std::to_string((std::uint64_t{1} << (b + 1)) - 1) : "") << std::setw(10)
+               << stats.histogram[b] << '\n';
+    os << std::setw(12) << "Roots" << std::setw(12) << "Calls" << std::setw(14) << "Blocks" << std::setw(12)
+       << "Time (ms)"
+       << "  Type\n";
+    for (const auto &t : stats.types)
+        os << std::setw(12) << t.roots << std::setw(12) << t.calls << std::setw(14) << t.blocks << std::setw(12)
+           << std::fixed << std::setprecision(3) << double(t.nanoseconds) / 1e6 << "  " << t.type << '\n';  // NOLINT
+    os << std::setw(38) << stats.untracked_blocks << "  (untracked)\n";
+    os.unsetf(std::ios::fixed);
+}
+}  // namespace ssz
@@ -0,0 +1,101 @@
+/*  hash_stats.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+namespace ssz {
+/**
+ *   \brief Counters of the SHA256 work: calls to Hasher::hash_64b_blocks, their blocks and time, and the blocks
+ *   hashed by each type in Container::hash_tree_root().
+ *   \details The counters are only updated when built with HASHER_STATS, see CMakeLists.txt, otherwise the hooks in
+ *   Hasher and Container compile to nothing and every counter stays at zero. Blocks are attributed to the innermost
+ *   hash_tree_root() running on the same thread, tasks on a thread pool have no type and are counted as untracked.
+ */
+class HashStats {
+   public:
+#ifdef HASHER_STATS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+    // Bucket b of the histogram counts the calls with [2^b, 2^(b+1)) blocks, the last one any larger call
+    static constexpr std::size_t BUCKETS = 24;
+
+    // Blocks and calls are those of the type itself, not of its fields, the time includes its fields
+    struct TypeTotals {
+        std::string type;
+        std::uint64_t roots, calls, blocks, nanoseconds;
+    };
+
+    struct Snapshot {
+        std::uint64_t calls = 0, blocks = 0, nanoseconds = 0, untracked_blocks = 0;
+        std::array<std::uint64_t, BUCKETS> histogram{};
+        std::vector<TypeTotals> types;  // most blocks first
+    };
+
+    static Snapshot snapshot();
+    static void reset();
+    static void dump(std::ostream &os);
+
+    static void record_call(std::size_t blocks, std::chrono::nanoseconds elapsed);
+
+    // Times a call to the hasher
+    class Call {
+       private:
+        std::size_t blocks_;
+        std::chrono::steady_clock::time_point start_;
+
+       public:
+        explicit Call(std::size_t blocks) : blocks_{blocks}, start_{std::chrono::steady_clock::now()} {}
+        ~Call() { record_call(blocks_, std::chrono::steady_clock::now() - start_); }
+        Call(const Call &) = delete;
+        Call &operator=(const Call &) = delete;
+    };
+
+    // Attributes the calls of the current thread to type while in scope
+    class TypeScope {
+       private:
+        std::type_index type_;
+        std::uint64_t calls_ = 0, blocks_ = 0;
+        TypeScope *parent_;
+        std::chrono::steady_clock::time_point start_;
+
+        friend class HashStats;
+
+       public:
+        explicit TypeScope(std::type_index type);
+        ~TypeScope();
+        TypeScope(const TypeScope &) = delete;
+        TypeScope &operator=(const TypeScope &) = delete;
+    };
+
+   private:
+    inline static thread_local TypeScope *scope_ = nullptr;
+};
+}  // namespace ssz
@@ -19,18 +19,47 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#if defined(__x86_64__) || defined(__i386__)
 #include <cpuid.h>
+#define HASHER_X86
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "ssz/hasher.hpp"
 #include "ssz/ssz.hpp"
 
+#ifdef HASHER_ASM
 extern "C" void sha256_1_avx(unsigned char* output, const unsigned char* input);
+#endif
 
 namespace {
+#ifdef HASHER_X86
 constexpr auto CPUID_LEAF = 7;
-}
+#endif
+// merkleize_subtrees keeps the levels of at most 2^SUBTREE_TILE_DEPTH chunks in its buffers, deeper subtrees are split
+constexpr std::size_t SUBTREE_TILE_DEPTH = 7;
+
+// Every kernel by name, fastest first
+constexpr std::array<std::pair<std::string_view, ssz::Hasher::IMPL>, 8> IMPL_NAMES{{
+    {"SHA", ssz::Hasher::IMPL::SHA},
+    {"AVX2", ssz::Hasher::IMPL::AVX2},
+    {"AVX", ssz::Hasher::IMPL::AVX},
+    {"SSE", ssz::Hasher::IMPL::SSE},
+    {"SHA_X4", ssz::Hasher::IMPL::SHA_X4},
+    {"AVX2_CXX", ssz::Hasher::IMPL::AVX2_CXX},
+    {"SSE41", ssz::Hasher::IMPL::SSE41},
+    {"GENERIC", ssz::Hasher::IMPL::GENERIC},
+}};
+}  // namespace
 
 namespace ssz {
+#ifdef HASHER_ASM
 void Hasher::sha256_sse(unsigned char* output, const unsigned char* input, std::size_t blocks) {
     while (blocks) {
         sha256_1_avx(output, input);
@@ -39,31 +68,106 @@ void Hasher::sha256_sse(unsigned char* output, const unsigned char* input, std::
         blocks--;
     }
 }
+#endif
 
+// Only the kernels that were built are reported, GENERIC is always available
 const Hasher::IMPL Hasher::implemented() {
-    IMPL ret = IMPL::NONE; 
-    std::uint32_t a, b, c, d;  // NOLINT
+    IMPL ret = IMPL::GENERIC;
+#ifdef HASHER_X86
+    [[maybe_unused]] IMPL assembly = IMPL::NONE;
+    std::uint32_t a = 0, b = 0, c = 0, d = 0;
     __get_cpuid_count(CPUID_LEAF, 0, &a, &b, &c, &d);
-    if (b & bit_SHA) ret = ret | IMPL::SHA;
-    if (b & bit_AVX2) ret = ret | IMPL::AVX2;
+    if (b & bit_SHA) {
+        ret = ret | IMPL::SHA_X4;
+        assembly = assembly | IMPL::SHA;
+    }
+    if (b & bit_AVX2) {
+        ret = ret | IMPL::AVX2_CXX;
+        assembly = assembly | IMPL::AVX2;
+    }
 
     __get_cpuid(1, &a, &b, &c, &d);
-    if (c & bit_AVX) ret = ret |  IMPL::AVX;
-    if (c & bit_SSE3) ret = ret | IMPL::SSE;
+    if (c & bit_AVX) assembly = assembly | IMPL::AVX;
+    if (c & bit_SSE3) assembly = assembly | IMPL::SSE;
+    if (c & bit_SSE4_1) ret = ret | IMPL::SSE41;
+#ifdef HASHER_ASM
+    ret = ret | assembly;
+#endif
+#endif
+    return ret;
+}
 
+std::vector<Hasher::IMPL> Hasher::available() {
+    auto impl = implemented();
+    std::vector<IMPL> ret;
+    for (const auto& [name, candidate] : IMPL_NAMES)
+        if (!!(impl & candidate)) ret.push_back(candidate);
     return ret;
 }
 
-Hasher::SHA256_hasher Hasher::best_sha256_implementation() {
-    auto impl = implemented(); 
-    if (!!(impl & IMPL::SHA)) return &::sha256_shani;
-    if (!!(impl & IMPL::AVX2)) return &::sha256_8_avx2;
-    if (!!(impl & IMPL::AVX)) return &::sha256_4_avx;
-    return &sha256_sse;
+Hasher::IMPL Hasher::best_implementation() { return available().front(); }
+
+std::string_view Hasher::name(IMPL impl) {
+    for (const auto& [name, candidate] : IMPL_NAMES)
+        if (candidate == impl) return name;
+    return "NONE";
 }
 
-Hasher::Hasher(Hasher::IMPL impl) {
+Hasher::IMPL Hasher::from_name(std::string_view name) {
+    for (const auto& [candidate_name, candidate] : IMPL_NAMES)
+        if (candidate_name == name) return candidate;
+    return IMPL::NONE;
+}
+
+const Hasher& Hasher::instance(IMPL impl) {
+    static const auto instances = [] {
+        std::array<Hasher, IMPL_NAMES.size()> ret{};
+        std::transform(IMPL_NAMES.cbegin(), IMPL_NAMES.cend(), ret.begin(),
+                       [](const auto& entry) { return Hasher{entry.second}; });
+        return ret;
+    }();
+    auto index = [](IMPL impl) {
+        return std::find_if(IMPL_NAMES.cbegin(), IMPL_NAMES.cend(),
+                            [impl](const auto& entry) { return entry.second == impl; }) -
+               IMPL_NAMES.cbegin();
+    };
+    auto i = index(impl);
+    if (i == IMPL_NAMES.size() || !(implemented() & impl)) i = index(best_implementation());
+    return instances[i];
+}
+
+void Hasher::merkleize_subtrees(unsigned char* output, const unsigned char* input, std::size_t count,
+                                std::size_t depth) const {
+    constexpr std::size_t chunk = constants::BYTES_PER_CHUNK;
+    if (depth == 0) {
+        std::memcpy(output, input, count * chunk);
+        return;
+    }
+    if (depth > SUBTREE_TILE_DEPTH) {
+        auto subtrees = count << (depth - SUBTREE_TILE_DEPTH);
+        std::vector<unsigned char> roots(subtrees * chunk);
+        merkleize_subtrees(roots.data(), input, subtrees, SUBTREE_TILE_DEPTH);
+        merkleize_subtrees(output, roots.data(), count, depth - SUBTREE_TILE_DEPTH);
+        return;
+    }
+    // Odd levels go to the first buffer and even ones to the second, the top level goes to output
+    std::array<unsigned char, (chunk << SUBTREE_TILE_DEPTH) / 2> odd;   // NOLINT
+    std::array<unsigned char, (chunk << SUBTREE_TILE_DEPTH) / 4> even;  // NOLINT
+    const std::size_t per_tile = std::size_t{1} << (SUBTREE_TILE_DEPTH - depth);
+    for (std::size_t first = 0; first < count; first += per_tile) {
+        auto blocks = std::min(per_tile, count - first) << (depth - 1);
+        const auto* in = input + (first << depth) * chunk;
+        for (std::size_t level = 1; level <= depth; ++level, blocks /= 2) {
+            auto* out = level == depth ? output + first * chunk : (level % 2 ? odd.data() : even.data());
+            hash_64b_blocks(out, in, blocks);
+            in = out;
+        }
+    }
+}
+
+Hasher::Hasher(Hasher::IMPL impl) : _impl{impl} {
     switch (impl) {
+#ifdef HASHER_ASM
         case IMPL::SHA:
             _hash_64b_blocks = sha256_shani;
             break;
@@ -76,8 +180,23 @@ Hasher::Hasher(Hasher::IMPL impl) {
         case IMPL::SSE:
             _hash_64b_blocks = &sha256_sse;
             break;
+#endif
+#ifdef HASHER_X86
+        case IMPL::SHA_X4:
+            _hash_64b_blocks = ::sha256_4_shani;
+            break;
+        case IMPL::AVX2_CXX:
+            _hash_64b_blocks = ::sha256_8_avx2_cxx;
+            break;
+        case IMPL::SSE41:
+            _hash_64b_blocks = ::sha256_4_sse41;
+            break;
+#endif
+        case IMPL::GENERIC:
+            _hash_64b_blocks = ::sha256_generic;
+            break;
         default:
-            _hash_64b_blocks = best_sha256_implementation();
+            *this = Hasher{best_implementation()};
     }
 }
 }  // namespace ssz
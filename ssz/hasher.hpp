@@ -21,12 +21,25 @@
 
 #pragma once
 
-#include <bits/c++config.h>
+#include <cstddef>
 #include <cstdint>
+#include <string_view>
+#include <vector>
 
+#include "ssz/hash_stats.hpp"
+
+// The assembly kernels are only built when yasm is available, see HASHER_ASM in CMakeLists.txt
+#ifdef HASHER_ASM
 extern "C" void sha256_4_avx(unsigned char* output, const unsigned char* input, std::size_t blocks);
 extern "C" void sha256_8_avx2(unsigned char* output, const unsigned char* input, std::size_t blocks);
 extern "C" void sha256_shani(unsigned char* output, const unsigned char* input, std::size_t blocks);
+#endif
+extern "C" void sha256_generic(unsigned char* output, const unsigned char* input, std::size_t blocks);
+#if defined(__x86_64__) || defined(__i386__)
+extern "C" void sha256_4_shani(unsigned char* output, const unsigned char* input, std::size_t blocks);
+extern "C" void sha256_4_sse41(unsigned char* output, const unsigned char* input, std::size_t blocks);
+extern "C" void sha256_8_avx2_cxx(unsigned char* output, const unsigned char* input, std::size_t blocks);
+#endif
 
 namespace ssz {
 
@@ -38,7 +51,13 @@ class Hasher {
             SSE  = 1,
             AVX  = 2,
             AVX2 = 4,
-            SHA  = 8
+            SHA  = 8,
+            // SHA extensions, four blocks interleaved instead of two
+            SHA_X4 = 16,
+            // Kernels in C++, without the assembly: one block at a time, and four or eight blocks per vector
+            GENERIC = 32,
+            SSE41 = 64,
+            AVX2_CXX = 128
         };
 
         inline friend IMPL operator |(IMPL a, IMPL b) noexcept {
@@ -51,26 +70,46 @@ class Hasher {
 
         inline friend bool operator !(IMPL a) noexcept { return a == IMPL::NONE; };
 
-        Hasher() : _hash_64b_blocks { best_sha256_implementation() } {};
+        Hasher() : Hasher{best_implementation()} {};
         Hasher(IMPL impl);
+
+        IMPL impl() const noexcept { return _impl; }
         
-        inline constexpr void hash_64b_blocks(unsigned char* output, const unsigned char* input, std::size_t blocks) const {
+        inline void hash_64b_blocks(unsigned char* output, const unsigned char* input, std::size_t blocks) const {
+#ifdef HASHER_STATS
+            HashStats::Call call{blocks};
+#endif
             _hash_64b_blocks(output, input, blocks);
         }
+
+        // Hashes each of the count consecutive subtrees of 2^depth chunks in input to its root in output, level by
+        // level with hash_64b_blocks. Only the roots are written to output.
+        void merkleize_subtrees(unsigned char* output, const unsigned char* input, std::size_t count,
+                                std::size_t depth) const;
         
         static const IMPL implemented(); 
-        
+        // The kernels built and supported by this CPU, fastest first
+        static std::vector<IMPL> available();
+        static IMPL best_implementation();
+
+        // Kernels by the name of their IMPL value, from_name returns NONE for unknown names
+        static std::string_view name(IMPL impl);
+        static IMPL from_name(std::string_view name);
 
+        // A Hasher shared by the whole process for each kernel, the best one if impl is not available
+        static const Hasher& instance(IMPL impl);
 
     private:
         typedef void (*SHA256_hasher)(unsigned char*, const unsigned char*, std::size_t);
         SHA256_hasher _hash_64b_blocks;
+        IMPL _impl;
         
-        static SHA256_hasher best_sha256_implementation();
+#ifdef HASHER_ASM
         static constexpr auto sha256_4_avx = ::sha256_4_avx;
         static constexpr auto sha256_8_avx2 = ::sha256_8_avx2;
         static constexpr auto sha256_shani = ::sha256_shani;
         static void sha256_sse(unsigned char* output, const unsigned char* input, std::size_t blocks);
+#endif
 };
 
 }  // namespace ssz
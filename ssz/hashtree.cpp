@@ -21,6 +21,8 @@
 
 #include "ssz/hashtree.hpp"
 
+#include <algorithm>
+#include <cstdlib>
 #include <stdexcept>
 
 #include "common/bytes.hpp"
@@ -54,6 +56,11 @@ auto zero_hash_array_helper() {
 
 const auto zero_hash_array = zero_hash_array_helper<ZERO_HASH_DEPTH>();
 
+// Parallel merkleization, by HashTreeCache and Merkleizer::append, hashes subtrees with at least 2^MIN_SUBTREE_HEIGHT
+// leaves, aiming at SUBTREES_PER_THREAD subtrees per thread to balance the load
+constexpr std::size_t MIN_SUBTREE_HEIGHT = 10;
+constexpr std::size_t SUBTREES_PER_THREAD = 4;
+
 /**
  *   \brief Packs a vector of bytes into chunks of 32 bytes
  *   \details If the length of vec is not a multiple of 32, it pads with null bytes in the end
@@ -74,37 +81,77 @@ std::vector<Chunk> pack_and_pad(const std::vector<std::uint8_t>& vec) {
     return ret;
 }
 
+// Hashes the nodes in [first, last) of the level above children, the last child may lack its sibling
+void hash_level(const Chunk* children, std::size_t children_count, Chunk* parents, std::size_t first,
+                std::size_t last, std::size_t height, const Hasher& hasher) {
+    if (2 * last > children_count) {
+        --last;
+        // NOLINTNEXTLINE
+        parents[last] = hash_2_chunks(children[children_count - 1], zero_hash_array[height], hasher);
+    }
+    // NOLINTNEXTLINE
+    if (last > first) hasher.hash_64b_blocks(parents[first].begin(), children[2 * first].begin(), last - first);
+}
+
+/**
+ *   \brief Computes the levels of a Merkle tree above its leaves
+ *   \details levels[i] holds counts[i + 1] nodes. With a thread pool the subtrees of height at least
+ *   MIN_SUBTREE_HEIGHT are hashed concurrently and only the levels above them are hashed serially.
+ */
+void merkleize_levels(const Chunk* leaves, const std::vector<Chunk*>& levels, const std::vector<std::size_t>& counts,
+                      const Hasher& hasher) {
+    auto children = [&](std::size_t height) -> const Chunk* { return height ? levels[height - 1] : leaves; };
+    std::size_t height = 0;
+    auto top = levels.size();
+    auto* pool = HashTree::thread_pool();
+    if (pool && counts[0] >= 2 * (1ul << MIN_SUBTREE_HEIGHT)) {
+        std::size_t subtree_height = helpers::log2ceil(counts[0] / (SUBTREES_PER_THREAD * (pool->size() + 1)));
+        subtree_height = std::min(std::max(subtree_height, MIN_SUBTREE_HEIGHT), top);
+        auto subtrees = (counts[0] + (1ul << subtree_height) - 1) >> subtree_height;
+        pool->parallel_for(subtrees, [&](std::size_t subtree) {
+            for (std::size_t h = 0; h < subtree_height; ++h) {
+                auto first = subtree << (subtree_height - h - 1);
+                auto last = std::min((subtree + 1) << (subtree_height - h - 1), counts[h + 1]);
+                hash_level(children(h), counts[h], levels[h], first, last, h, hasher);
+            }
+        });
+        height = subtree_height;
+    }
+    for (; height < top; ++height)
+        hash_level(children(height), counts[height], levels[height], 0, counts[height + 1], height, hasher);
+}
+
 void merkleize(const std::vector<Chunk>& vec, std::vector<Chunk>& hash_tree, std::size_t limit, const Hasher& hasher) {
-    auto depth = helpers::log2ceil(limit);
-    auto first = hash_tree.begin();
-    auto last = first + (vec.size() + 1) / 2;  // NOLINT
-    if (vec.size() > 1) hasher.hash_64b_blocks(hash_tree[0].begin(), vec[0].begin(), vec.size() / 2);
-    if (vec.size() % 2) *std::prev(last) = hash_2_chunks(vec.back(), zero_hash, hasher);
-    auto dist = std::distance(first, last);
-    auto height = 1;
-    while (dist > 1) {
-        hasher.hash_64b_blocks((*last).begin(), (*first).begin(), dist / 2);
-        first = last;
-        last += (dist + 1) / 2;
-        // NOLINTNEXTLINE 
-        if (dist % 2) *std::prev(last) = hash_2_chunks(*std::prev(first), zero_hash_array[height], hasher);
-        height++;
-        dist = std::distance(first, last);
+    std::size_t depth = helpers::log2ceil(limit);
+    std::vector<std::size_t> counts{vec.size()};
+    std::vector<Chunk*> levels;
+    std::size_t offset = 0;
+    while (counts.back() > 1) {
+        counts.push_back((counts.back() + 1) / 2);
+        levels.push_back(&hash_tree[offset]);
+        offset += counts.back();
     }
-    while (height < depth) {
-        *last = hash_2_chunks(*std::prev(last), zero_hash_array[height], hasher);  // NOLINT
-        last++;
-        height++;
+    merkleize_levels(vec.data(), levels, counts, hasher);
+
+    auto root = levels.empty() ? vec.back() : hash_tree[offset - 1];
+    for (auto height = levels.size(); height < depth; ++height, ++offset) {
+        root = hash_2_chunks(root, zero_hash_array[height], hasher);
+        hash_tree[offset] = root;
     }
-    hash_tree.resize(std::distance(hash_tree.begin(), last));
+    hash_tree.resize(offset);
 }
 
 }  // namespace
 
 namespace ssz {
-#ifndef CUSTOM_HASHER
-const auto HashTree::hasher = Hasher{};
-#endif
+std::atomic<const Hasher*>& HashTree::process_hasher() {
+    static std::atomic<const Hasher*> hasher{[] {
+        const char* name = std::getenv("MAMMON_HASHER");
+        return &Hasher::instance(name ? Hasher::from_name(name) : Hasher::IMPL::NONE);
+    }()};
+    return hasher;
+}
+
 HashTree::HashTree(const std::vector<Chunk>& chunks, std::uint64_t limit) {
     // return early if only one chunk:
     if (limit <= 1 && chunks.size() == 1)
@@ -119,15 +166,219 @@ HashTree::HashTree(const std::vector<Chunk>& chunks, std::uint64_t limit) {
         hash_tree_.resize(std::max(cache_size, 1ul));
 
         if (limit == 0) limit = std::bit_ceil(chunks.size());
-        merkleize(chunks, hash_tree_, limit, hasher);
+        merkleize(chunks, hash_tree_, limit, hasher());
     }
 }
 
 void HashTree::mix_in(std::size_t length) {
     auto length_bytes = eth::Bytes32(length);
-    hash_tree_.push_back(hash_2_chunks(this->hash_tree_root(), length_bytes.to_array(), hasher));
+    hash_tree_.push_back(hash_2_chunks(this->hash_tree_root(), length_bytes.to_array(), hasher()));
 }
 
 HashTree::HashTree(const std::vector<std::uint8_t>& vec, std::uint64_t limit) : HashTree{pack_and_pad(vec), limit} {};
 
+void HashTreeCache::clear() {
+    levels_.clear();
+    dirty_.clear();
+    full_rebuild_ = false;
+}
+
+void HashTreeCache::assign(std::vector<Chunk>&& leaves) {
+    clear();
+    if (leaves.empty()) return;
+    levels_.push_back(std::move(leaves));
+    full_rebuild_ = true;
+}
+
+void HashTreeCache::resize(std::size_t count) {
+    auto old_size = size();
+    if (count == old_size) return;
+    if (count == 0) {
+        clear();
+        return;
+    }
+    if (levels_.empty()) levels_.emplace_back();
+    levels_.front().resize(count);
+    if (full_rebuild_) return;
+    if (count > old_size) {
+        for (auto i = old_size; i < count; ++i) dirty_.push_back(i);
+        return;
+    }
+    // When shrinking only the path of the new last leaf changes, its old siblings are now zero hashes
+    std::erase_if(dirty_, [count](std::size_t i) { return i >= count; });
+    dirty_.push_back(count - 1);
+}
+
+void HashTreeCache::update(std::size_t index, const Chunk& chunk) {
+    levels_.front()[index] = chunk;
+    if (!full_rebuild_) dirty_.push_back(index);
+}
+
+// Rehashes the parents of the dirty nodes in level and replaces dirty by those parents. Consecutive parents are
+// hashed in place, isolated ones are gathered and hashed in a single call to the hasher.
+void HashTreeCache::rehash_level(std::size_t level, std::vector<std::size_t>& dirty) {
+    const auto& children = levels_[level];
+    auto& parents = levels_[level + 1];
+    for (auto& index : dirty) index /= 2;
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    std::vector<Chunk> gathered_children;
+    std::vector<std::size_t> gathered;
+    for (auto it = dirty.begin(); it != dirty.end();) {
+        auto run_end = std::next(it);
+        while (run_end != dirty.end() && *run_end == *std::prev(run_end) + 1) ++run_end;
+        auto first = *it;
+        auto last = *std::prev(run_end) + 1;
+        if (2 * last > children.size()) {
+            --last;
+            parents[last] = hash_2_chunks(children.back(), zero_hash_array[level], HashTree::hasher());
+        }
+        if (last - first > 1) {
+            HashTree::hasher().hash_64b_blocks(parents[first].begin(), children[2 * first].begin(), last - first);
+        } else if (last - first == 1) {
+            gathered_children.push_back(children[2 * first]);
+            gathered_children.push_back(children[2 * first + 1]);
+            gathered.push_back(first);
+        }
+        it = run_end;
+    }
+    if (gathered.empty()) return;
+    std::vector<Chunk> digests(gathered.size());
+    HashTree::hasher().hash_64b_blocks(digests[0].begin(), gathered_children[0].begin(), gathered.size());
+    for (std::size_t i = 0; i < gathered.size(); ++i) parents[gathered[i]] = digests[i];
+}
+
+Chunk HashTreeCache::hash_tree_root() {
+    auto effective_depth = helpers::log2ceil(size());
+    auto depth = limit_ ? helpers::log2ceil(limit_) : effective_depth;
+    if (levels_.empty()) return zero_hash_array[depth];
+
+    levels_.resize(effective_depth + 1);
+    for (auto level = levels_.begin() + 1; level != levels_.end(); ++level)
+        level->resize((std::prev(level)->size() + 1) / 2);
+
+    if (full_rebuild_) {
+        std::vector<Chunk*> levels;
+        std::vector<std::size_t> counts{size()};
+        for (auto level = levels_.begin() + 1; level != levels_.end(); ++level) {
+            levels.push_back(level->data());
+            counts.push_back(level->size());
+        }
+        merkleize_levels(levels_.front().data(), levels, counts, HashTree::hasher());
+        full_rebuild_ = false;
+    } else if (!dirty_.empty()) {
+        std::sort(dirty_.begin(), dirty_.end());
+        dirty_.erase(std::unique(dirty_.begin(), dirty_.end()), dirty_.end());
+        for (std::size_t level = 0; level + 1 < levels_.size(); ++level) rehash_level(level, dirty_);
+    }
+    dirty_.clear();
+
+    auto root = levels_.back().front();
+    for (auto height = effective_depth; height < depth; ++height)
+        root = hash_2_chunks(root, zero_hash_array[height], HashTree::hasher());
+    return root;
+}
+
+Chunk mix_in(const Chunk& root, std::size_t length) {
+    auto length_bytes = eth::Bytes32(length);
+    return hash_2_chunks(root, length_bytes.to_array(), HashTree::hasher());
+}
+
+void merkleize_many(const Chunk* leaves, std::size_t count, std::size_t width, Chunk* roots, std::size_t stride) {
+    if (count == 0) return;
+    auto depth = helpers::log2ceil(width);
+    if (stride == 1) {
+        HashTree::hasher().merkleize_subtrees(roots->begin(), leaves->begin(), count, depth);
+        return;
+    }
+    std::vector<Chunk> contiguous(count);
+    HashTree::hasher().merkleize_subtrees(contiguous[0].begin(), leaves->begin(), count, depth);
+    for (std::size_t i = 0; i < count; ++i) roots[i * stride] = contiguous[i];  // NOLINT
+}
+
+// Returns the root of the tree of the given depth whose first count leaves start at first, count <= BATCH_SIZE
+Chunk Merkleizer::merkleize_batch(const Chunk* first, std::size_t count, std::size_t depth) {
+    if (count == 0) return zero_hash_array[depth];
+    std::array<std::array<Chunk, BATCH_SIZE / 2>, 2> buffers;  // NOLINT
+    const Chunk* current = first;
+    std::size_t height = 0;
+    for (; count > 1; ++height) {
+        auto& next = buffers[height % 2];
+        HashTree::hasher().hash_64b_blocks(next[0].begin(), current->begin(), count / 2);
+        // NOLINTNEXTLINE
+        if (count % 2) next[count / 2] = hash_2_chunks(current[count - 1], zero_hash_array[height], HashTree::hasher());
+        count = (count + 1) / 2;
+        current = next.data();
+    }
+    auto root = *current;
+    for (; height < depth; ++height) root = hash_2_chunks(root, zero_hash_array[height], HashTree::hasher());
+    return root;
+}
+
+void Merkleizer::push_node(Chunk node, std::size_t level) {
+    const auto added = std::uint64_t{1} << level;
+    for (auto pending = batches_ >> level; pending & 1; pending >>= 1, ++level)
+        node = hash_2_chunks(nodes_[level], node, HashTree::hasher());
+    nodes_[level] = node;
+    batches_ += added;
+}
+
+void Merkleizer::flush_batch() {
+    Chunk node;  // NOLINT
+    HashTree::hasher().merkleize_subtrees(node.begin(), batch_[0].begin(), 1, BATCH_DEPTH);
+    push_node(node, 0);
+    batch_count_ = 0;
+}
+
+void Merkleizer::append(std::span<const Chunk> chunks) {
+    std::size_t first = 0;
+    auto *pool = HashTree::thread_pool();
+    if (pool && chunks.size() >= 2 * (1ul << MIN_SUBTREE_HEIGHT)) {
+        std::size_t height = helpers::log2ceil(chunks.size() / (SUBTREES_PER_THREAD * (pool->size() + 1)));
+        height = std::max(height, MIN_SUBTREE_HEIGHT);
+        // The chunks up to the start of a subtree of that height go one by one
+        const auto count = batches_ * BATCH_SIZE + batch_count_;
+        const auto start = ((count + (1ul << height) - 1) >> height) << height;
+        for (; first < std::min<std::size_t>(start - count, chunks.size()); ++first) push_back(chunks[first]);
+
+        std::vector<Chunk> roots((chunks.size() - first) >> height);
+        const auto &hasher = HashTree::hasher();
+        pool->parallel_for(roots.size(), [&](std::size_t i) {
+            hasher.merkleize_subtrees(roots[i].begin(), chunks[first + (i << height)].begin(), 1, height);
+        });
+        for (const auto &root : roots) push_node(root, height - BATCH_DEPTH);
+        first += roots.size() << height;
+    }
+    for (; first < chunks.size(); ++first) push_back(chunks[first]);
+}
+
+void Merkleizer::pack(std::span<const std::uint8_t> bytes) {
+    const auto full = bytes.size() / constants::BYTES_PER_CHUNK;
+    append({reinterpret_cast<const Chunk *>(bytes.data()), full});  // NOLINT
+    if (auto length = bytes.size() % constants::BYTES_PER_CHUNK) {
+        Chunk chunk{};
+        std::copy_n(bytes.begin() + full * constants::BYTES_PER_CHUNK, length, chunk.begin());  // NOLINT
+        push_back(chunk);
+    }
+}
+
+Chunk Merkleizer::hash_tree_root() const {
+    auto count = batches_ * BATCH_SIZE + batch_count_;
+    if (limit_ && count > limit_) throw std::out_of_range("more chunks than the limit");
+    std::size_t depth = limit_ ? helpers::log2ceil(limit_) : helpers::log2ceil(count);
+    if (!batches_) return merkleize_batch(batch_.data(), batch_count_, depth);
+    // the tree is full and its root is already the last pending node
+    if ((batches_ >> (depth - BATCH_DEPTH)) & 1) return nodes_[depth - BATCH_DEPTH];
+
+    // the pending batch is the next subtree of depth BATCH_DEPTH, the completed ones are in nodes_
+    auto node = merkleize_batch(batch_.data(), batch_count_, BATCH_DEPTH);
+    for (auto height = BATCH_DEPTH; height < depth; ++height) {
+        if ((batches_ >> (height - BATCH_DEPTH)) & 1)
+            node = hash_2_chunks(nodes_[height - BATCH_DEPTH], node, HashTree::hasher());
+        else
+            node = hash_2_chunks(node, zero_hash_array[height], HashTree::hasher());
+    }
+    return node;
+}
+
 }  // namespace ssz
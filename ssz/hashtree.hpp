@@ -21,19 +21,31 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstring>
+#include <mutex>
+#include <span>
+#include <utility>
 #include <vector>
 
+#include "helpers/thread_pool.hpp"
 #include "ssz/hasher.hpp"
 #include "ssz/ssz.hpp"
 
 namespace ssz {
 class HashTree {
    private:
-    static const Hasher hasher;
     std::vector<Chunk> hash_tree_;
+    friend class HashTreeCache;
+    friend class Merkleizer;
+    friend class ScopedHasher;
+
+    inline static helpers::ThreadPool* thread_pool_ = nullptr;
+    inline static thread_local const Hasher* thread_hasher_ = nullptr;
+    static std::atomic<const Hasher*>& process_hasher();
 
    public:
     explicit HashTree(const std::vector<Chunk>& chunks, std::uint64_t limit = 0);
@@ -42,6 +54,208 @@ class HashTree {
     void mix_in(std::size_t length);
     std::vector<Chunk> hash_tree() const { return hash_tree_; }
     const Chunk hash_tree_root() const { return hash_tree_.back(); }
+
+    // Large trees are hashed in parallel on this pool, nullptr (the default) hashes on the calling thread
+    static void thread_pool(helpers::ThreadPool* pool) { thread_pool_ = pool; }
+    static helpers::ThreadPool* thread_pool() { return thread_pool_; }
+
+    // The hasher of the calling thread: the one of its ScopedHasher if any, otherwise the process-wide one
+    static const Hasher& hasher() {
+        return thread_hasher_ ? *thread_hasher_ : *process_hasher().load(std::memory_order_relaxed);
+    }
+    // Switches the process-wide hasher. It starts as the kernel named by the MAMMON_HASHER environment variable, see
+    // Hasher::name(), or the best available one.
+    static void hasher(Hasher::IMPL impl) { process_hasher().store(&Hasher::instance(impl)); }
+};
+
+/**
+ *   \brief Overrides the hasher of the calling thread while in scope.
+ *   \details Meant for tests, tasks sent to HashTree::thread_pool() keep using the process-wide hasher.
+ */
+class ScopedHasher {
+   private:
+    const Hasher* previous_;
+
+   public:
+    explicit ScopedHasher(Hasher::IMPL impl) : previous_{HashTree::thread_hasher_} {
+        HashTree::thread_hasher_ = &Hasher::instance(impl);
+    }
+    ~ScopedHasher() { HashTree::thread_hasher_ = previous_; }
+    ScopedHasher(const ScopedHasher&) = delete;
+    ScopedHasher& operator=(const ScopedHasher&) = delete;
+};
+
+Chunk mix_in(const Chunk &root, std::size_t length);
+
+// Computes the roots of count consecutive trees of width leaves each, width a power of two, and writes them at
+// roots[i * stride], with Hasher::merkleize_subtrees.
+void merkleize_many(const Chunk *leaves, std::size_t count, std::size_t width, Chunk *roots, std::size_t stride = 1);
+
+/**
+ *   \brief Computes the root of a Merkle tree without storing the tree.
+ *   \details Chunks are hashed in batches of BATCH_SIZE as they are added and only one pending node per level is
+ *   kept, the zero padding up to the limit is folded in with the zero hashes when computing the root.
+ */
+class Merkleizer {
+   private:
+    static constexpr std::size_t BATCH_DEPTH = 6;
+    static constexpr std::size_t BATCH_SIZE = 1ul << BATCH_DEPTH;
+    static constexpr std::size_t MAX_DEPTH = 64;
+
+    std::array<Chunk, BATCH_SIZE> batch_;
+    std::array<Chunk, MAX_DEPTH - BATCH_DEPTH> nodes_;
+    std::size_t batch_count_ = 0;
+    std::uint64_t batches_ = 0;
+    std::uint64_t limit_;
+
+    static Chunk merkleize_batch(const Chunk *first, std::size_t count, std::size_t depth);
+    void flush_batch();
+    // Adds the root of the next subtree of 2^(BATCH_DEPTH + level) chunks, the batches so far fill whole subtrees
+    void push_node(Chunk node, std::size_t level);
+
+   public:
+    explicit Merkleizer(std::uint64_t limit = 0) : limit_{limit} {};
+
+    void push_back(const Chunk &chunk) {
+        batch_[batch_count_++] = chunk;
+        if (batch_count_ == BATCH_SIZE) flush_batch();
+    }
+    // With HashTree::thread_pool() the large subtrees of many chunks are hashed in parallel
+    void append(std::span<const Chunk> chunks);
+    // Packs bytes into chunks, the last one is padded with zeroes
+    void pack(std::span<const std::uint8_t> bytes);
+
+    // Throws std::out_of_range if more chunks than the limit were added
+    Chunk hash_tree_root() const;
+    Chunk hash_tree_root(std::size_t length) const { return mix_in(hash_tree_root(), length); }
+};
+
+/**
+ *   \brief Cache of the non-zero part of the Merkle tree of a list.
+ *   \details Leaves are set with update() and only the paths from the leaves changed since the last call to
+ *   hash_tree_root() are rehashed. The zero padding up to the limit is never stored, see assets/design.md
+ */
+class HashTreeCache {
+   private:
+    std::vector<std::vector<Chunk>> levels_;
+    std::vector<std::size_t> dirty_;
+    std::uint64_t limit_;
+    bool full_rebuild_ = false;
+
+    void rehash_level(std::size_t level, std::vector<std::size_t> &dirty);
+
+   public:
+    explicit HashTreeCache(std::uint64_t limit = 0) : limit_{limit} {};
+
+    std::size_t size() const { return levels_.empty() ? 0 : levels_.front().size(); }
+    std::uint64_t limit() const { return limit_; }
+    void limit(std::uint64_t limit) { limit_ = limit; }
+    void clear();
+    void assign(std::vector<Chunk> &&leaves);
+    void resize(std::size_t count);
+    void update(std::size_t index, const Chunk &chunk);
+    Chunk hash_tree_root();
+    Chunk hash_tree_root(std::size_t length) { return mix_in(hash_tree_root(), length); }
+};
+
+/**
+ *   \brief The HashTreeCache of a list with the elements changed since its last root, updated by hash_tree() const.
+ *   \details Every access is locked, so that as for any other container the root of a const list can be computed
+ *   from several threads at once. The lock is never held while leaves are computed or the tree is rebuilt, as both
+ *   may wait on HashTree::thread_pool(), whose waiting threads run queued tasks that may need this same lock. Copies
+ *   lock the source and get their own mutex.
+ */
+class ListTreeCache {
+   private:
+    struct State {
+        HashTreeCache tree;
+        std::vector<std::size_t> dirty;  // elements changed since the last root
+        bool stale = true;               // every element changed, the tree is rebuilt
+        std::uint64_t generation = 0;    // roots committed to the tree so far
+    };
+
+    mutable std::mutex mutex_;
+    mutable State state_;
+
+    State state() const {
+        std::lock_guard lock{mutex_};
+        return state_;
+    }
+
+   public:
+    explicit ListTreeCache(std::uint64_t limit = 0) : state_{HashTreeCache{limit}, {}, true, 0} {}
+    ListTreeCache(const ListTreeCache& other) : state_{other.state()} {}
+    ListTreeCache(ListTreeCache&& other) noexcept : state_{std::move(other.state_)} {}
+    ListTreeCache& operator=(const ListTreeCache& other) {
+        if (this == &other) return *this;
+        auto state = other.state();
+        std::lock_guard lock{mutex_};
+        state_ = std::move(state);
+        return *this;
+    }
+    ListTreeCache& operator=(ListTreeCache&& other) noexcept {
+        std::lock_guard lock{mutex_};
+        state_ = std::move(other.state_);
+        return *this;
+    }
+    ~ListTreeCache() = default;
+
+    void limit(std::uint64_t limit) {
+        std::lock_guard lock{mutex_};
+        state_.tree.limit(limit);
+    }
+    void changed(std::size_t index) {
+        std::lock_guard lock{mutex_};
+        state_.dirty.push_back(index);
+    }
+    void invalidate() {
+        std::lock_guard lock{mutex_};
+        state_.stale = true;
+    }
+
+    /**
+     *   \brief The root of a list of length elements in count leaves, elements_per_leaf to a leaf.
+     *   \details The changes are read under the lock, then all_leaves() or changed_leaves(indices), the leaves at the
+     *   sorted indices that changed, are computed without it and committed under it again. Concurrent callers
+     *   compute the same leaves, the first one to commit updates the tree and the others only return their root.
+     */
+    template <class AllLeaves, class ChangedLeaves>
+    Chunk hash_tree_root(std::size_t count, std::size_t length, std::size_t elements_per_leaf, AllLeaves all_leaves,
+                         ChangedLeaves changed_leaves) const {
+        std::unique_lock lock{mutex_};
+        const auto generation = state_.generation;
+        const auto stale = state_.stale;
+        auto dirty = state_.dirty;
+        HashTreeCache tree{state_.tree.limit()};
+        lock.unlock();
+
+        if (stale) {
+            tree.assign(all_leaves());
+            auto root = tree.hash_tree_root(length);
+            lock.lock();
+            if (state_.generation == generation) {
+                state_.tree = std::move(tree);
+                state_.dirty.clear();
+                state_.stale = false;
+                ++state_.generation;
+            }
+            return root;
+        }
+
+        for (auto& index : dirty) index /= elements_per_leaf;
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        std::vector<Chunk> leaves = changed_leaves(dirty);
+        lock.lock();
+        if (state_.generation == generation) {
+            state_.tree.resize(count);
+            for (std::size_t i = 0; i < dirty.size(); ++i) state_.tree.update(dirty[i], leaves[i]);
+            state_.dirty.clear();
+            ++state_.generation;
+        }
+        // Only the paths of the changed leaves are rehashed, without the thread pool
+        return state_.tree.hash_tree_root(length);
+    }
 };
 
 }  // namespace ssz
@@ -0,0 +1,272 @@
+/*  schema.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/bytes.hpp"
+#include "helpers/bytes_to_int.hpp"
+#include "ssz/hashtree.hpp"
+#include "ssz/ssz.hpp"
+#include "ssz/ssz_container.hpp"
+#include "yaml-cpp/yaml.h"
+
+namespace ssz {
+
+// Types with a static ssz_size are fixed sized, any other type is encoded behind an offset in its parent
+template <class T>
+concept FixedSized = requires { T::ssz_size; };
+
+template <class T>
+constexpr std::size_t fixed_part_size() {
+    if constexpr (FixedSized<T>)
+        return T::ssz_size;
+    else
+        return constants::BYTES_PER_LENGTH_OFFSET;
+}
+
+// A field of the container C of type F, name is its key in YAML
+template <class C, class F>
+struct Field {
+    using type = F;
+    const char *name;
+    F C::*member;
+};
+
+template <class C, class F>
+constexpr Field<C, F> field(const char *name, F C::*member) {
+    return {name, member};
+}
+
+// Containers that describe their fields, in order, by a static constexpr fields() returning a tuple of Field
+template <class T>
+concept HasFields = requires { T::fields(); };
+
+template <class T, std::size_t I>
+using field_t = typename std::tuple_element_t<I, decltype(T::fields())>::type;
+
+template <class T>
+inline constexpr std::size_t field_count = std::tuple_size_v<decltype(T::fields())>;
+
+// Lists and vectors of SSZ objects
+template <class T>
+concept Sequence = requires { typename T::value_type; };
+
+// Fixed sized types other than containers and vectors are merkleized by packing their encoding: basic types, byte
+// vectors and bitvectors
+template <class T>
+concept PackedRoot = FixedSized<T> && !HasFields<T> && !Sequence<T>;
+
+/**
+ *   \brief Computes the roots of count values of type T, get(i) returns the i-th value, and writes them at
+ *   out[i * stride].
+ *   \details Containers with a schema are merkleized level by level across all the values: the roots of each field
+ *   are computed for every value first, recursively, and then the trees of all values are hashed with
+ *   merkleize_many. Packed types larger than a chunk are batched the same way. Any other type falls back to
+ *   hash_tree_root() per value.
+ */
+template <class T, class Get>
+void hash_tree_roots(std::size_t count, Get get, Chunk *out, std::size_t stride = 1) {
+    if constexpr (HasFields<T>) {
+        constexpr auto width = std::bit_ceil(field_count<T>);
+        std::vector<Chunk> leaves(count * width);
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (hash_tree_roots<field_t<T, I>>(
+                 count,
+                 [&get](std::size_t i) -> decltype(auto) {
+                     constexpr auto member = std::get<I>(T::fields()).member;
+                     return (get(i).*member);
+                 },
+                 leaves.data() + I, width),
+             ...);
+        }
+        (std::make_index_sequence<field_count<T>>{});
+        merkleize_many(leaves.data(), count, width, out, stride);
+    } else if constexpr (PackedRoot<T>) {
+        constexpr std::size_t chunks = (T::ssz_size + constants::BYTES_PER_CHUNK - 1) / constants::BYTES_PER_CHUNK;
+        constexpr auto width = std::bit_ceil(chunks);
+        std::vector<Chunk> leaves(count * width);
+        for (std::size_t i = 0; i < count; ++i) get(i).T::serialize_into({leaves[i * width].data(), T::ssz_size});
+        merkleize_many(leaves.data(), count, width, out, stride);
+    } else
+        for (std::size_t i = 0; i < count; ++i) out[i * stride] = get(i).hash_tree_root();  // NOLINT
+}
+
+/**
+ *   \brief Base class of containers with a compile time schema.
+ *   \details Derived lists its fields in a static constexpr fields(), from which the SSZ and YAML codecs are
+ *   generated: the fixed part offsets are constants and each field is (de)serialized through its static type.
+ *   Containers that set parallel_hash_tree compute the roots of their fields on Container::thread_pool().
+ */
+template <class Derived>
+class SchemaContainer : public Container {
+   private:
+    const Derived &self() const { return static_cast<const Derived &>(*this); }
+    Derived &self() { return static_cast<Derived &>(*this); }
+
+    static constexpr std::size_t fixed_length() {
+        return []<std::size_t... I>(std::index_sequence<I...>) {
+            return (std::size_t{0} + ... + fixed_part_size<field_t<Derived, I>>());
+        }
+        (std::make_index_sequence<field_count<Derived>>{});
+    }
+
+    static constexpr bool fixed_sized() {
+        return []<std::size_t... I>(std::index_sequence<I...>) { return (FixedSized<field_t<Derived, I>> && ...); }
+        (std::make_index_sequence<field_count<Derived>>{});
+    }
+
+    template <class F>
+    static std::size_t serialize_field(const F &value, std::span<std::uint8_t> out, std::size_t position,
+                                       std::uint32_t &offset) {
+        if constexpr (FixedSized<F>)
+            return value.F::serialize_into(out.subspan(position));
+        else {
+            eth::Bytes4(offset).serialize_into(out.subspan(position));
+            offset += std::uint32_t(value.F::serialize_into(out.subspan(offset)));
+            return constants::BYTES_PER_LENGTH_OFFSET;
+        }
+    }
+
+    // The variable part of a field is only known when the next offset is read, last_variable keeps it until then
+    template <class F>
+    static bool deserialize_field(F &value, SSZIterator begin, SSZIterator &it, SSZIterator end,
+                                  std::uint32_t &last_offset, Container *&last_variable) {
+        if constexpr (FixedSized<F>) {
+            if (std::size_t(std::distance(it, end)) < F::ssz_size) return false;
+            if (!value.F::deserialize(it, it + F::ssz_size)) return false;  // NOLINT
+            it += F::ssz_size;                                              // NOLINT
+        } else {
+            if (std::distance(it, end) < constants::BYTES_PER_LENGTH_OFFSET) return false;
+            auto current_offset = helpers::to_integer_little_endian<std::uint32_t>(&*it);
+            if (std::distance(begin, end) < current_offset) return false;
+
+            if (last_offset) {
+                if (current_offset < last_offset) return false;
+                if (!last_variable->deserialize(begin + last_offset, begin + current_offset)) return false;
+            } else if (current_offset != fixed_length())
+                return false;
+
+            last_offset = current_offset;
+            last_variable = &value;
+            it += constants::BYTES_PER_LENGTH_OFFSET;
+        }
+        return true;
+    }
+
+   protected:
+    std::vector<Chunk> hash_tree() const override {
+        constexpr auto count = field_count<Derived>;
+        auto parts = std::apply(
+            [this](const auto &...f) { return std::array<const Container *, count>{&(self().*f.member)...}; },
+            Derived::fields());
+        std::array<Chunk, count> roots;  // NOLINT
+        auto compute = [&](std::size_t i) { roots[i] = parts[i]->hash_tree_root(); };
+
+        bool parallel = false;
+        if constexpr (requires { Derived::parallel_hash_tree; }) parallel = Derived::parallel_hash_tree;
+        if (auto *pool = thread_pool(); parallel && pool)
+            pool->parallel_for(count, compute);
+        else
+            for (std::size_t i = 0; i < count; ++i) compute(i);
+
+        Merkleizer merkleizer{};
+        for (const auto &root : roots) merkleizer.push_back(root);
+        return {merkleizer.hash_tree_root()};
+    }
+
+   public:
+    std::size_t get_ssz_size() const override {
+        if constexpr (FixedSized<Derived>)
+            static_assert(fixed_sized() && Derived::ssz_size == fixed_length(), "ssz_size does not match fields()");
+        if constexpr (fixed_sized())
+            return fixed_length();
+        else
+            return 0;
+    }
+
+    std::size_t serialized_size() const override {
+        return std::apply(
+            [this](const auto &...f) {
+                auto variable_size = [](const auto &value) -> std::size_t {
+                    using F = std::remove_cvref_t<decltype(value)>;
+                    if constexpr (FixedSized<F>)
+                        return 0;
+                    else
+                        return value.F::serialized_size();
+                };
+                return (fixed_length() + ... + variable_size(self().*f.member));
+            },
+            Derived::fields());
+    }
+
+    std::size_t serialize_into(std::span<std::uint8_t> out) const override {
+        SSZ_TRACE_SCOPE("serialize_into");
+        constexpr auto fixed = fixed_length();
+        if (out.size() < fixed) throw std::out_of_range("buffer too small for SSZ encoding");
+
+        // Write the fixed parts and the offsets, the variable parts go after the fixed ones in order
+        std::size_t position = 0;
+        std::uint32_t offset = fixed;
+        std::apply(
+            [&](const auto &...f) { ((position += serialize_field(self().*f.member, out, position, offset)), ...); },
+            Derived::fields());
+        return offset;
+    }
+
+    bool deserialize(SSZIterator it, SSZIterator end) override {
+        SSZ_TRACE_SCOPE("deserialize");
+        SSZIterator begin = it;
+        std::uint32_t last_offset = 0;
+        Container *last_variable = nullptr;
+        if (!std::apply(
+                [&](const auto &...f) {
+                    return (deserialize_field(self().*f.member, begin, it, end, last_offset, last_variable) && ...);
+                },
+                Derived::fields()))
+            return false;
+        if (last_offset)
+            if (!last_variable->deserialize(begin + last_offset, end)) return false;
+        return true;
+    }
+
+    YAML::Node encode() const override {
+        YAML::Node node;
+        std::apply([&](const auto &...f) { ((node[f.name] = (self().*f.member).encode()), ...); }, Derived::fields());
+        return node;
+    }
+
+    bool decode(const YAML::Node &node) override {
+        return std::apply([&](const auto &...f) { return ((self().*f.member).decode(node[f.name]) && ...); },
+                          Derived::fields());
+    }
+};
+}  // namespace ssz
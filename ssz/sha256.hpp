@@ -0,0 +1,133 @@
+/*  sha256.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// SHA256 of 64 bytes blocks in C++, shared by the kernels that do not use the assembly in ssz/*.asm. The
+// compression is written once for a word type V: std::uint32_t hashes a single block and a GCC vector of 32 bit
+// words hashes one block per lane.
+namespace ssz::sha256 {
+constexpr std::size_t BLOCK_SIZE = 64;
+constexpr std::size_t DIGEST_SIZE = 32;
+constexpr std::size_t ROUNDS = 64;
+
+alignas(64) inline constexpr std::array<std::uint32_t, ROUNDS> K256{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+inline constexpr std::array<std::uint32_t, 8> IV{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                                 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+// Message schedule of the padding block of a 64 bytes message with the round constants already added
+alignas(64) inline constexpr std::array<std::uint32_t, ROUNDS> PADDING{
+    0xc28a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf374,
+    0x649b69c1, 0xf0fe4786, 0x0fe1edc6, 0x240cf254, 0x4fe9346f, 0x6cc984be, 0x61b9411e, 0x16f988fa,
+    0xf2c65152, 0xa88e5a6d, 0xb019fc65, 0xb9d99ec7, 0x9a1231c3, 0xe70eeaa0, 0xfdb1232b, 0xc7353eb0,
+    0x3069bad5, 0xcb976d5f, 0x5a0f118f, 0xdc1eeefd, 0x0a35b689, 0xde0b7a04, 0x58f4ca9d, 0xe15d5b16,
+    0x007f3e86, 0x37088980, 0xa507ea32, 0x6fab9537, 0x17406110, 0x0d8cd6f1, 0xcdaa3b6d, 0xc0bbbe37,
+    0x83613bda, 0xdb48a363, 0x0b02e931, 0x6fd15ca7, 0x521afaca, 0x31338431, 0x6ed41a95, 0x6d437890,
+    0xc39c91f2, 0x9eccabbd, 0xb5c9a0e6, 0x532fb63c, 0xd2c741c6, 0x07237ea3, 0xa4954b68, 0x4c191d76};
+
+template <class V>
+[[gnu::always_inline]] inline V rotr(V x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+// Compresses into state the message whose schedule, with the round constants already added, is wk. The words of wk
+// are either of type V or scalars that are broadcast to every lane.
+template <class V, class W>
+[[gnu::always_inline]] inline void rounds(std::array<V, 8> &state, const std::array<W, ROUNDS> &wk) {
+    auto [a, b, c, d, e, f, g, h] = state;
+    for (std::size_t t = 0; t < ROUNDS; ++t) {
+        auto t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + wk[t];
+        auto t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state = {state[0] + a, state[1] + b, state[2] + c, state[3] + d,
+             state[4] + e, state[5] + f, state[6] + g, state[7] + h};
+}
+
+// Expands the first 16 words of w to the full message schedule and compresses it into state
+template <class V>
+[[gnu::always_inline]] inline void compress(std::array<V, 8> &state, std::array<V, ROUNDS> &w) {
+    for (std::size_t t = 16; t < ROUNDS; ++t) {
+        auto s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+        auto s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+        w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+    for (std::size_t t = 0; t < ROUNDS; ++t) w[t] += K256[t];
+    rounds(state, w);
+}
+
+/**
+ *   \brief Hashes N consecutive 64 bytes blocks, each to its 32 bytes digest.
+ *   \details V is std::uint32_t when N is 1, otherwise a vector of N words with one block per lane.
+ */
+template <class V, std::size_t N>
+[[gnu::always_inline]] inline void hash_lanes(unsigned char *output, const unsigned char *input) {
+    auto word = [](const unsigned char *in) -> std::uint32_t {
+        return std::uint32_t(in[0]) << 24 | std::uint32_t(in[1]) << 16 | std::uint32_t(in[2]) << 8 | in[3];
+    };
+    std::array<V, ROUNDS> w;  // NOLINT
+    for (std::size_t t = 0; t < 16; ++t) {
+        if constexpr (N == 1)
+            w[t] = word(input + 4 * t);
+        else
+            for (std::size_t l = 0; l < N; ++l) w[t][l] = word(input + l * BLOCK_SIZE + 4 * t);
+    }
+    std::array<V, 8> state;  // NOLINT
+    for (std::size_t i = 0; i < state.size(); ++i) state[i] = V{} + IV[i];
+    compress(state, w);
+    // The second block is the padding of a 512 bits message, its schedule is the same for every block
+    rounds(state, PADDING);
+
+    for (std::size_t i = 0; i < state.size(); ++i)
+        for (std::size_t l = 0; l < N; ++l) {
+            std::uint32_t v;  // NOLINT
+            if constexpr (N == 1)
+                v = state[i];
+            else
+                v = state[i][l];
+            auto *out = output + l * DIGEST_SIZE + 4 * i;
+            out[0] = v >> 24;
+            out[1] = v >> 16;
+            out[2] = v >> 8;
+            out[3] = v;
+        }
+}
+}  // namespace ssz::sha256
@@ -1,4 +1,4 @@
-/*  bench_sha256_shani.cpp
+/*  sha256_generic.cpp
  *
  *  This file is part of Mammon.
  *  mammon is a greedy and selfish ETH consensus client.
@@ -19,21 +19,10 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <iostream>
-#include "bench/bench_sha256_impl.hpp"
 #include "ssz/hasher.hpp"
-#include "ssz/hashtree.hpp"
+#include "ssz/sha256.hpp"
 
-const auto ssz::HashTree::hasher = ssz::Hasher{ssz::Hasher::IMPL::@CMAKE_HASHER_IMPL@};
-
-int main(int argc, const char* argv[]) {
-    if (argc < 2) {
-        std::cout << "Usage: " << argv[0] << " <state.ssz>\n";
-        return 1;
-    }
-
-    std::cout << "Implementation         Average (ms)       Slowest\n";
-    std::cout << "-------------------------------------------------\n";
-    std::cout << "@CMAKE_HASHER_IMPL@ :                      ";
-    return bench::bench_sha256_impl(argv[1]);
+void sha256_generic(unsigned char* output, const unsigned char* input, std::size_t blocks) {
+    for (; blocks; --blocks, input += ssz::sha256::BLOCK_SIZE, output += ssz::sha256::DIGEST_SIZE)
+        ssz::sha256::hash_lanes<std::uint32_t, 1>(output, input);
 }
@@ -0,0 +1,130 @@
+/*  sha256_shani_x4.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  SHA-NI kernel that hashes four 64 bytes blocks at a time. sha256rnds2 has a latency of several cycles and each
+ *  round pair depends on the previous one, interleaving the rounds of independent blocks fills the pipeline. With
+ *  four lanes the states and message schedules no longer fit in the sixteen xmm registers, so the register
+ *  allocation is left to the compiler.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "ssz/hasher.hpp"
+#include "ssz/sha256.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+namespace {
+using ssz::sha256::BLOCK_SIZE;
+using ssz::sha256::DIGEST_SIZE;
+using ssz::sha256::K256;
+using ssz::sha256::PADDING;
+constexpr std::size_t ROUND_GROUPS = 16;
+constexpr std::size_t LANES = 4;
+
+// Hashes N consecutive blocks, the rounds of the N lanes are issued one after the other
+template <std::size_t N>
+[[gnu::target("sha,ssse3,sse4.1")]] void hash_lanes(unsigned char* output, const unsigned char* input) {
+    const __m128i shuf_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    const __m128i abef_init = _mm_set_epi32(0x6a09e667, 0xbb67ae85, 0x510e527f, static_cast<int>(0x9b05688c));
+    const __m128i cdgh_init = _mm_set_epi32(0x3c6ef372, static_cast<int>(0xa54ff53a), 0x1f83d9ab, 0x5be0cd19);
+
+    // The message schedules are expanded first, so that only the states are live during the rounds
+    __m128i schedule[N][ROUND_GROUPS];  // NOLINT
+    __m128i state0[N], state1[N];       // NOLINT
+#pragma GCC unroll 4
+    for (std::size_t l = 0; l < N; ++l) {
+        auto& w = schedule[l];
+#pragma GCC unroll 4
+        for (std::size_t g = 0; g < 4; ++g)
+            w[g] = _mm_shuffle_epi8(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + l * BLOCK_SIZE + g * 16)),  // NOLINT
+                shuf_mask);
+#pragma GCC unroll 16
+        for (std::size_t g = 4; g < ROUND_GROUPS; ++g)
+            w[g] = _mm_sha256msg2_epu32(
+                _mm_add_epi32(_mm_sha256msg1_epu32(w[g - 4], w[g - 3]), _mm_alignr_epi8(w[g - 1], w[g - 2], 4)),
+                w[g - 1]);
+#pragma GCC unroll 16
+        for (std::size_t g = 0; g < ROUND_GROUPS; ++g)
+            w[g] = _mm_add_epi32(w[g],
+                                 _mm_load_si128(reinterpret_cast<const __m128i*>(K256.data() + 4 * g)));  // NOLINT
+        state0[l] = abef_init;
+        state1[l] = cdgh_init;
+    }
+
+#pragma GCC unroll 16
+    for (std::size_t g = 0; g < ROUND_GROUPS; ++g) {
+#pragma GCC unroll 4
+        for (std::size_t l = 0; l < N; ++l) {
+            state1[l] = _mm_sha256rnds2_epu32(state1[l], state0[l], schedule[l][g]);
+            state0[l] = _mm_sha256rnds2_epu32(state0[l], state1[l], _mm_shuffle_epi32(schedule[l][g], 0x0E));
+        }
+    }
+
+    __m128i abef_save[N], cdgh_save[N];  // NOLINT
+#pragma GCC unroll 4
+    for (std::size_t l = 0; l < N; ++l) {
+        state0[l] = abef_save[l] = _mm_add_epi32(state0[l], abef_init);
+        state1[l] = cdgh_save[l] = _mm_add_epi32(state1[l], cdgh_init);
+    }
+
+#pragma GCC unroll 16
+    for (std::size_t g = 0; g < ROUND_GROUPS; ++g) {
+        const __m128i padding = _mm_load_si128(reinterpret_cast<const __m128i*>(PADDING.data() + 4 * g));  // NOLINT
+        const __m128i padding_hi = _mm_shuffle_epi32(padding, 0x0E);
+#pragma GCC unroll 4
+        for (std::size_t l = 0; l < N; ++l) {
+            state1[l] = _mm_sha256rnds2_epu32(state1[l], state0[l], padding);
+            state0[l] = _mm_sha256rnds2_epu32(state0[l], state1[l], padding_hi);
+        }
+    }
+
+    // ABEF and CDGH back to ABCD and EFGH in big endian
+#pragma GCC unroll 4
+    for (std::size_t l = 0; l < N; ++l) {
+        const __m128i feba = _mm_shuffle_epi32(_mm_add_epi32(state0[l], abef_save[l]), 0x1B);
+        const __m128i dchg = _mm_shuffle_epi32(_mm_add_epi32(state1[l], cdgh_save[l]), 0xB1);
+        auto* out = output + l * DIGEST_SIZE;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),  // NOLINT
+                         _mm_shuffle_epi8(_mm_blend_epi16(feba, dchg, 0xF0), shuf_mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16),  // NOLINT
+                         _mm_shuffle_epi8(_mm_alignr_epi8(dchg, feba, 8), shuf_mask));
+    }
+}
+}  // namespace
+
+void sha256_4_shani(unsigned char* output, const unsigned char* input, std::size_t blocks) {
+    for (; blocks >= LANES; blocks -= LANES, input += LANES * BLOCK_SIZE, output += LANES * DIGEST_SIZE)
+        hash_lanes<LANES>(output, input);
+    if (blocks >= 2) {
+        hash_lanes<2>(output, input);
+        blocks -= 2;
+        input += 2 * BLOCK_SIZE;
+        output += 2 * DIGEST_SIZE;
+    }
+    if (blocks) hash_lanes<1>(output, input);
+}
+#endif
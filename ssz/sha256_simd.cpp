@@ -0,0 +1,57 @@
+/*  sha256_simd.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  SHA256 kernels that hash one block per lane of a vector register, compiled from the C++ in ssz/sha256.hpp for
+ *  the instruction set of each entry point. Blocks that do not fill the vector are hashed by sha256_generic.
+ */
+
+#include <cstdint>
+
+#include "ssz/hasher.hpp"
+#include "ssz/sha256.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+namespace {
+using u32x4 = std::uint32_t __attribute__((vector_size(16)));
+using u32x8 = std::uint32_t __attribute__((vector_size(32)));
+}  // namespace
+
+[[gnu::target("sse4.1")]] void sha256_4_sse41(unsigned char* output, const unsigned char* input,
+                                               std::size_t blocks) {
+    constexpr std::size_t lanes = 4;
+    for (; blocks >= lanes; blocks -= lanes) {
+        ssz::sha256::hash_lanes<u32x4, lanes>(output, input);
+        input += lanes * ssz::sha256::BLOCK_SIZE;
+        output += lanes * ssz::sha256::DIGEST_SIZE;
+    }
+    sha256_generic(output, input, blocks);
+}
+
+[[gnu::target("avx2")]] void sha256_8_avx2_cxx(unsigned char* output, const unsigned char* input,
+                                                std::size_t blocks) {
+    constexpr std::size_t lanes = 8;
+    for (; blocks >= lanes; blocks -= lanes) {
+        ssz::sha256::hash_lanes<u32x8, lanes>(output, input);
+        input += lanes * ssz::sha256::BLOCK_SIZE;
+        output += lanes * ssz::sha256::DIGEST_SIZE;
+    }
+    sha256_4_sse41(output, input, blocks);
+}
+#endif
@@ -21,27 +21,26 @@
 
 #pragma once
 #include <cstddef>
-#include <string>
+#include <span>
+#include <typeinfo>
 #include <vector>
 
+#include "helpers/thread_pool.hpp"
+#include "ssz/hash_stats.hpp"
 #include "ssz/ssz.hpp"
+#include "ssz/trace.hpp"
 #include "yaml-cpp/yaml.h"
 
 namespace ssz {
-class Container;
-using Part = std::pair<std::string, Container *>;
-using ConstPart = std::pair<std::string, const Container *>;
 using SSZIterator = std::vector<std::uint8_t>::const_iterator;
 
 class Container {
    protected:
-    static std::vector<std::uint8_t> serialize_(const std::vector<const Container *> &);
-    static bool deserialize_(SSZIterator it, SSZIterator end, const std::vector<Container *> &);
-    static YAML::Node encode_(const std::vector<ConstPart> &parts);
-    static bool decode_(const YAML::Node &node, std::vector<Part> parts);
-    static std::vector<Chunk> hash_tree_(const std::vector<const Container *> &);
     virtual std::vector<Chunk> hash_tree() const;
 
+   private:
+    inline static helpers::ThreadPool *thread_pool_ = nullptr;
+
    public:
     virtual ~Container() = default;
     Container() = default;
@@ -51,10 +50,31 @@ class Container {
     Container &operator=(const Container &) = default;
 
     virtual std::size_t get_ssz_size() const { return 0; }
-    virtual std::vector<std::uint8_t> serialize() const = 0;
+    // Length of the SSZ encoding, only variable sized types need to override it
+    virtual std::size_t serialized_size() const { return get_ssz_size(); }
+    // Writes the SSZ encoding at the start of out, which must hold serialized_size() bytes, and returns its length
+    virtual std::size_t serialize_into(std::span<std::uint8_t> out) const = 0;
+    std::vector<std::uint8_t> serialize() const {
+        SSZ_TRACE_SCOPE("serialize");
+        std::vector<std::uint8_t> ret(serialized_size());
+        serialize_into(ret);
+        return ret;
+    }
     virtual bool deserialize(SSZIterator it, SSZIterator end) = 0;
 
-    Chunk hash_tree_root() const { return this->hash_tree().back(); }
+    Chunk hash_tree_root() const {
+#ifdef HASHER_STATS
+        HashStats::TypeScope scope{typeid(*this)};
+#endif
+        SSZ_TRACE_SCOPE("hash_tree_root");
+        return this->hash_tree().back();
+    }
+
+    // Containers that set parallel_hash_tree compute the roots of their fields concurrently on this pool, nullptr
+    // (the default) computes them on the calling thread. It may also be HashTree::thread_pool(): the lists that
+    // cache their trees never wait on a pool while holding their lock, as the waiting thread runs field roots too.
+    static void thread_pool(helpers::ThreadPool *pool) { thread_pool_ = pool; }
+    static helpers::ThreadPool *thread_pool() { return thread_pool_; }
 
     virtual YAML::Node encode() const = 0;
     virtual bool decode(const YAML::Node &node) = 0;
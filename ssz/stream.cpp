@@ -0,0 +1,173 @@
+/*  stream.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ssz/stream.hpp"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+
+namespace ssz {
+namespace {
+std::array<int, 2> wake_pipe() {
+    std::array<int, 2> ret{};
+    if (::pipe(ret.data())) throw std::system_error(errno, std::generic_category(), "could not create a pipe");
+    return ret;
+}
+}  // namespace
+
+StreamReader::StreamReader(std::istream &in, std::size_t block_size, std::size_t depth)
+    : StreamReader(
+          [&in](std::uint8_t *out, std::size_t count) -> std::ptrdiff_t {
+              in.read(reinterpret_cast<char *>(out), std::streamsize(count));  // NOLINT
+              if (in.gcount()) return in.gcount();
+              return in.bad() ? -1 : 0;
+          },
+          block_size, depth, false) {}
+
+// Waits for fd or the wake-up pipe, the latter is an error as the reader is being destroyed
+StreamReader::StreamReader(int fd, std::size_t block_size, std::size_t depth)
+    : StreamReader(
+          [this, fd](std::uint8_t *out, std::size_t count) -> std::ptrdiff_t {
+              std::array<pollfd, 2> fds{{{fd, POLLIN, 0}, {wake_[0], POLLIN, 0}}};
+              while (true) {
+                  if (::poll(fds.data(), fds.size(), -1) < 0) {
+                      if (errno == EINTR) continue;
+                      return -1;
+                  }
+                  if (fds[1].revents) return -1;
+                  auto ret = ::read(fd, out, count);
+                  if (ret >= 0 || (errno != EINTR && errno != EAGAIN)) return ret;
+              }
+          },
+          block_size, depth, true) {}
+
+StreamReader::StreamReader(Source source, std::size_t block_size, std::size_t depth, bool interruptible)
+    : block_size_{std::max<std::size_t>(block_size, 1)},
+      depth_{std::max<std::size_t>(depth, 1)},
+      source_{std::move(source)},
+      wake_{interruptible ? wake_pipe() : std::array{-1, -1}},
+      thread_{&StreamReader::fill, this} {}
+
+StreamReader::~StreamReader() {
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+    drained_.notify_all();
+    if (wake_[1] >= 0) {
+        const std::uint8_t byte = 0;
+        while (::write(wake_[1], &byte, 1) < 0 && errno == EINTR) {
+        }
+    }
+    thread_.join();
+    for (auto fd : wake_)
+        if (fd >= 0) ::close(fd);
+}
+
+void StreamReader::fill() {
+    while (true) {
+        std::vector<std::uint8_t> block;
+        {
+            std::unique_lock lock{mutex_};
+            drained_.wait(lock, [this] { return stop_ || blocks_.size() < depth_; });
+            if (stop_) return;
+            if (!free_.empty()) {
+                block = std::move(free_.front());
+                free_.pop_front();
+            }
+        }
+        // Up to a block, a pipe or a socket returns what has arrived so far and it is decoded right away
+        block.resize(block_size_);
+        std::ptrdiff_t got = -1;
+        try {
+            got = source_(block.data(), block_size_);
+        } catch (...) {
+        }
+        const auto size = std::size_t(std::max<std::ptrdiff_t>(got, 0));
+        block.resize(size);
+        {
+            std::lock_guard lock{mutex_};
+            if (size) blocks_.push_back(std::move(block));
+            done_ = got <= 0;
+            error_ = got < 0;
+        }
+        filled_.notify_one();
+        if (got <= 0) return;
+    }
+}
+
+bool StreamReader::next_block() {
+    std::unique_lock lock{mutex_};
+    filled_.wait(lock, [this] { return done_ || !blocks_.empty(); });
+    if (blocks_.empty()) return false;
+    if (block_.capacity()) free_.push_back(std::move(block_));
+    block_ = std::move(blocks_.front());
+    blocks_.pop_front();
+    offset_ = 0;
+    lock.unlock();
+    drained_.notify_one();
+    return true;
+}
+
+std::size_t StreamReader::available() {
+    while (offset_ == block_.size())
+        if (!next_block()) return 0;
+    return block_.size() - offset_;
+}
+
+std::optional<StreamReader::Range> StreamReader::read(std::size_t count) {
+    if (!count || available() >= count) {
+        Range ret{block_.cbegin() + std::ptrdiff_t(offset_), block_.cbegin() + std::ptrdiff_t(offset_ + count)};
+        offset_ += count;
+        position_ += count;
+        return ret;
+    }
+    scratch_.clear();
+    scratch_.reserve(count);
+    while (scratch_.size() < count) {
+        auto size = std::min(available(), count - scratch_.size());
+        if (!size) return std::nullopt;
+        scratch_.insert(scratch_.end(), block_.cbegin() + std::ptrdiff_t(offset_),
+                        block_.cbegin() + std::ptrdiff_t(offset_ + size));
+        offset_ += size;
+    }
+    position_ += count;
+    return Range{scratch_.cbegin(), scratch_.cend()};
+}
+
+StreamReader::Range StreamReader::read_all() {
+    scratch_.clear();
+    while (auto size = available()) {
+        scratch_.insert(scratch_.end(), block_.cbegin() + std::ptrdiff_t(offset_), block_.cend());
+        offset_ += size;
+    }
+    position_ += scratch_.size();
+    return {scratch_.cbegin(), scratch_.cend()};
+}
+
+bool StreamReader::error() const {
+    std::lock_guard lock{mutex_};
+    return error_;
+}
+}  // namespace ssz
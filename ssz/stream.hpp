@@ -0,0 +1,188 @@
+/*  stream.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "helpers/bytes_to_int.hpp"
+#include "ssz/schema.hpp"
+#include "ssz/ssz_container.hpp"
+
+namespace ssz {
+/**
+ *   \brief Reads an input stream or a file descriptor ahead of the decoder, in blocks.
+ *   \details A thread reads blocks of up to block_size bytes while the previous ones are decoded, holding at most
+ *   depth of them, each one as much as the source returns at once. Reads that fit in the current block are views into it, those that straddle two blocks are copied, so
+ *   that the bytes are copied once from the source and usually not again before being decoded.
+ *
+ *   Destroying the reader before the end of the source, as when decoding fails early, stops the thread: a file
+ *   descriptor is polled together with a wake-up pipe so that a socket or a pipe still open is not waited on. An
+ *   istream cannot be interrupted, its reads must end or fail on their own.
+ */
+class StreamReader {
+   public:
+    using Range = std::pair<SSZIterator, SSZIterator>;
+
+    static constexpr std::size_t BLOCK_SIZE = 1U << 20U;
+    static constexpr std::size_t DEPTH = 4;
+
+    explicit StreamReader(std::istream &in, std::size_t block_size = BLOCK_SIZE, std::size_t depth = DEPTH);
+    explicit StreamReader(int fd, std::size_t block_size = BLOCK_SIZE, std::size_t depth = DEPTH);
+    StreamReader(const StreamReader &) = delete;
+    StreamReader &operator=(const StreamReader &) = delete;
+    ~StreamReader();
+
+    // Bytes left in the current block, the next block is waited for when it is exhausted, 0 at the end
+    std::size_t available();
+    // The next count bytes, nullopt if the stream ends before, valid until the next call
+    std::optional<Range> read(std::size_t count);
+    // Everything up to the end of the stream
+    Range read_all();
+    // Bytes read so far
+    std::uint64_t position() const { return position_; }
+    // The source failed, as opposed to ending
+    bool error() const;
+
+   private:
+    using Source = std::function<std::ptrdiff_t(std::uint8_t *, std::size_t)>;  // -1 on error, 0 at the end
+
+    std::size_t block_size_, depth_;
+    Source source_;
+    mutable std::mutex mutex_;
+    std::condition_variable filled_, drained_;
+    std::deque<std::vector<std::uint8_t>> blocks_, free_;
+    bool done_ = false, error_ = false, stop_ = false;
+
+    std::vector<std::uint8_t> block_, scratch_;
+    std::size_t offset_ = 0;  // in block_
+    std::uint64_t position_ = 0;
+    std::array<int, 2> wake_{-1, -1};  // written to on destruction, for file descriptors only
+    std::thread thread_;               // last, it starts reading once everything else is constructed
+
+    StreamReader(Source source, std::size_t block_size, std::size_t depth, bool interruptible);
+    void fill();
+    bool next_block();
+};
+
+// Lists of fixed sized elements that can be decoded a piece at a time
+template <class T>
+concept AppendableList = requires(T value, SSZIterator it) {
+    T::value_type::ssz_size;
+    value.reserve(std::size_t{});
+    { value.deserialize_append(it, it) } -> std::same_as<bool>;
+};
+
+namespace stream {
+// A variable sized part until the end of the stream
+inline constexpr std::size_t TO_END = std::numeric_limits<std::size_t>::max();
+
+// Decodes length bytes of reader into value, lists of fixed sized elements as the blocks arrive
+template <class T>
+bool deserialize_part(StreamReader &reader, T &value, std::size_t length) {
+    if constexpr (AppendableList<T>) {
+        constexpr std::size_t element = T::value_type::ssz_size;
+        static const std::vector<std::uint8_t> empty;
+        if (!value.deserialize(empty.cbegin(), empty.cend())) return false;
+        if (length != TO_END) value.reserve(length / element);
+        while (length) {
+            auto available = reader.available();
+            if (!available) return length == TO_END;
+            // The whole elements in the block, or one element across two blocks
+            auto count = std::max(std::min(length, available) / element * element, element);
+            if (length != TO_END && count > length) return false;
+            auto range = reader.read(count);
+            if (!range || !value.deserialize_append(range->first, range->second)) return false;
+            if (length != TO_END) length -= count;
+        }
+        return true;
+    } else {
+        auto range = length == TO_END ? std::optional{reader.read_all()} : reader.read(length);
+        return range && value.T::deserialize(range->first, range->second);
+    }
+}
+}  // namespace stream
+
+/**
+ *   \brief Decodes object from the whole of reader as its bytes arrive.
+ *   \details The fields of a container with a schema are decoded in order from the blocks of the reader: the fixed
+ *   ones first, keeping the offsets of the variable ones, and then each variable part, whose length is the
+ *   difference of consecutive offsets. Lists of fixed sized elements, such as the validators and balances of a
+ *   BeaconState, are decoded a piece at a time, so that the memory held besides the object is the blocks of the
+ *   reader and the largest other field. Any other type is read whole and decoded as usual.
+ */
+template <class T>
+bool deserialize(StreamReader &reader, T &object) {
+    if constexpr (!HasFields<T>) {
+        if (!stream::deserialize_part(reader, object, stream::TO_END)) return false;
+    } else {
+        constexpr auto count = field_count<T>;
+        std::array<std::uint32_t, count> offsets{};
+        auto fixed_part = [&]<std::size_t I>(std::integral_constant<std::size_t, I>) {
+            using F = field_t<T, I>;
+            auto &value = object.*(std::get<I>(T::fields()).member);
+            if constexpr (FixedSized<F>)
+                return stream::deserialize_part(reader, value, F::ssz_size);
+            else {
+                auto range = reader.read(constants::BYTES_PER_LENGTH_OFFSET);
+                if (!range) return false;
+                offsets[I] = helpers::to_integer_little_endian<std::uint32_t>(&*range->first);
+                return true;
+            }
+        };
+        // Each variable part starts where the previous one ends, the first one right after the fixed part
+        auto variable_part = [&]<std::size_t I>(std::integral_constant<std::size_t, I>) {
+            using F = field_t<T, I>;
+            if constexpr (FixedSized<F>)
+                return true;
+            else {
+                if (offsets[I] != reader.position()) return false;
+                std::optional<std::uint32_t> next;
+                [&]<std::size_t... J>(std::index_sequence<J...>) {
+                    ((J > I && !FixedSized<field_t<T, J>> && !next ? (next = offsets[J], 0) : 0), ...);
+                }
+                (std::make_index_sequence<count>{});
+                if (next && *next < offsets[I]) return false;
+                auto &value = object.*(std::get<I>(T::fields()).member);
+                return stream::deserialize_part(reader, value, next ? *next - offsets[I] : stream::TO_END);
+            }
+        };
+        if (![&]<std::size_t... I>(std::index_sequence<I...>) {
+                return (fixed_part(std::integral_constant<std::size_t, I>{}) && ...) &&
+                       (variable_part(std::integral_constant<std::size_t, I>{}) && ...);
+            }(std::make_index_sequence<count>{}))
+            return false;
+    }
+    return !reader.available() && !reader.error();
+}
+}  // namespace ssz
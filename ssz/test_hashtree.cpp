@@ -0,0 +1,256 @@
+/*  test_hashtree.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "helpers/thread_pool.hpp"
+#include "include/acutest.h"
+#include "ssz/hash_stats.hpp"
+#include "ssz/hashtree.hpp"
+#include "ssz/ssz.hpp"
+
+using namespace ssz;
+
+namespace {
+constexpr auto LIST_LIMIT = 1ul << 20;  // NOLINT
+
+std::vector<Chunk> random_chunks(std::size_t count, std::mt19937_64 &gen) {
+    std::vector<Chunk> ret(count);
+    for (auto &chunk : ret)
+        for (auto &byte : chunk) byte = std::uint8_t(gen());
+    return ret;
+}
+
+Chunk expected_root(const std::vector<Chunk> &chunks, std::uint64_t limit) {
+    if (chunks.empty()) return HashTree{std::vector<Chunk>(1), limit}.hash_tree_root();
+    return HashTree{chunks, limit}.hash_tree_root();
+}
+}  // namespace
+
+void test_cache_full_rebuild() {
+    std::mt19937_64 gen{1};  // NOLINT
+    for (std::size_t count : {1, 2, 3, 5, 8, 13, 100, 1025}) {  // NOLINT
+        auto chunks = random_chunks(count, gen);
+        HashTreeCache cache{LIST_LIMIT};
+        cache.assign(std::vector<Chunk>{chunks});
+        TEST_CHECK(cache.hash_tree_root() == expected_root(chunks, LIST_LIMIT));  // NOLINT
+        TEST_MSG("count: %zu", count);                                             // NOLINT
+    }
+}
+
+void test_cache_updates() {
+    std::mt19937_64 gen{2};  // NOLINT
+    auto chunks = random_chunks(1000, gen);  // NOLINT
+    HashTreeCache cache{LIST_LIMIT};
+    cache.assign(std::vector<Chunk>{chunks});
+    cache.hash_tree_root();
+    for (auto round = 0; round < 10; ++round) {  // NOLINT
+        auto updates = random_chunks(round * 7 + 1, gen);
+        for (auto &chunk : updates) {
+            auto index = gen() % chunks.size();
+            chunks[index] = chunk;
+            cache.update(index, chunk);
+        }
+        TEST_CHECK(cache.hash_tree_root() == expected_root(chunks, LIST_LIMIT));  // NOLINT
+        TEST_MSG("round: %d", round);                                              // NOLINT
+    }
+}
+
+void test_cache_resize() {
+    std::mt19937_64 gen{3};  // NOLINT
+    std::vector<Chunk> chunks;
+    HashTreeCache cache{LIST_LIMIT};
+    TEST_CHECK(cache.hash_tree_root() == expected_root(chunks, LIST_LIMIT));  // NOLINT
+    for (std::size_t count : {1, 2, 3, 4, 5, 9, 64, 65, 33, 31, 7, 1}) {  // NOLINT
+        auto old_size = chunks.size();
+        chunks.resize(count);
+        cache.resize(count);
+        for (auto i = old_size; i < count; ++i) {
+            chunks[i] = random_chunks(1, gen).front();
+            cache.update(i, chunks[i]);
+        }
+        TEST_CHECK(cache.hash_tree_root() == expected_root(chunks, LIST_LIMIT));  // NOLINT
+        TEST_MSG("count: %zu", count);                                             // NOLINT
+    }
+}
+
+void test_merkleizer() {
+    std::mt19937_64 gen{4};  // NOLINT
+    for (std::uint64_t limit : {0ul, LIST_LIMIT}) {
+        for (std::size_t count : {0, 1, 2, 3, 63, 64, 65, 127, 128, 129, 192, 256, 1000, 4096}) {  // NOLINT
+            if (count == 0 && limit == 0) continue;
+            auto chunks = random_chunks(count, gen);
+            Merkleizer merkleizer{limit};
+            for (const auto &chunk : chunks) merkleizer.push_back(chunk);
+            TEST_CHECK(merkleizer.hash_tree_root() == expected_root(chunks, limit));  // NOLINT
+            TEST_MSG("count: %zu, limit: %lu", count, limit);                          // NOLINT
+        }
+    }
+    // One chunk past the limit, within the first batch or after whole ones
+    for (std::uint64_t limit : {4ul, 64ul, 128ul}) {  // NOLINT
+        Merkleizer merkleizer{limit};
+        for (const auto &chunk : random_chunks(limit + 1, gen)) merkleizer.push_back(chunk);
+        TEST_EXCEPTION(merkleizer.hash_tree_root(), std::out_of_range);  // NOLINT
+        TEST_MSG("limit: %lu", limit);                                    // NOLINT
+    }
+}
+
+void test_merkleizer_pack() {
+    std::mt19937_64 gen{5};  // NOLINT
+    for (std::size_t length : {1, 31, 32, 33, 2049, 4100}) {  // NOLINT
+        std::vector<std::uint8_t> bytes(length);
+        for (auto &byte : bytes) byte = std::uint8_t(gen());
+        Merkleizer merkleizer{LIST_LIMIT};
+        merkleizer.pack(bytes);
+        HashTree expected{bytes, LIST_LIMIT};
+        expected.mix_in(length);
+        TEST_CHECK(merkleizer.hash_tree_root(length) == expected.hash_tree_root());  // NOLINT
+        TEST_MSG("length: %zu", length);                                             // NOLINT
+    }
+}
+
+void test_parallel_merkleization() {
+    std::mt19937_64 gen{6};  // NOLINT
+    helpers::ThreadPool pool{3};
+    for (std::size_t count : {2048, 5000, 65536, 100001}) {  // NOLINT
+        auto chunks = random_chunks(count, gen);
+        auto expected = expected_root(chunks, LIST_LIMIT);
+        HashTreeCache cache{LIST_LIMIT};
+        cache.assign(std::vector<Chunk>{chunks});
+
+        HashTree::thread_pool(&pool);
+        TEST_CHECK(HashTree(chunks, LIST_LIMIT).hash_tree_root() == expected);  // NOLINT
+        TEST_CHECK(cache.hash_tree_root() == expected);                         // NOLINT
+        // Starting anywhere in the tree, the chunks before the first whole subtree are added one by one
+        for (std::size_t before : {0, 1, 100, 1024}) {  // NOLINT
+            Merkleizer merkleizer{LIST_LIMIT};
+            for (std::size_t i = 0; i < std::min(before, count); ++i) merkleizer.push_back(chunks[i]);
+            merkleizer.append(std::span(chunks).subspan(std::min(before, count)));
+            TEST_CHECK(merkleizer.hash_tree_root() == expected);  // NOLINT
+            TEST_MSG("count: %zu, before: %zu", count, before);   // NOLINT
+        }
+        TEST_MSG("count: %zu", count);  // NOLINT
+        HashTree::thread_pool(nullptr);
+    }
+}
+
+void test_parallel_for_exception() {
+    helpers::ThreadPool pool{3};
+    std::atomic<std::size_t> done{0};
+    auto throwing = [&](std::size_t i) {
+        if (i % 7 == 0) throw std::runtime_error("task");  // NOLINT
+        done.fetch_add(1);
+    };
+    TEST_EXCEPTION(pool.parallel_for(100, throwing), std::runtime_error);  // NOLINT
+    // Every other task ran to completion before the exception got to the caller
+    TEST_CHECK(done.load() == 100 - 15);  // NOLINT
+    done = 0;
+    pool.parallel_for(10, [&](std::size_t) { done.fetch_add(1); });  // NOLINT
+    TEST_CHECK(done.load() == 10);                                   // NOLINT
+}
+
+void test_merkleize_many() {
+    std::mt19937_64 gen{7};  // NOLINT
+    for (std::size_t width : {1, 2, 4, 8, 32, 512}) {  // NOLINT
+        for (std::size_t count : {1, 3, 9, 100}) {     // NOLINT
+            auto chunks = random_chunks(count * width, gen);
+            constexpr std::size_t stride = 3;
+            std::vector<Chunk> roots(count * stride);
+            merkleize_many(chunks.data(), count, width, roots.data(), stride);
+            for (std::size_t i = 0; i < count; ++i) {
+                std::vector<Chunk> tree(chunks.begin() + i * width, chunks.begin() + (i + 1) * width);
+                TEST_CHECK(roots[i * stride] == expected_root(tree, 0));         // NOLINT
+                TEST_MSG("width: %zu, count: %zu, tree: %zu", width, count, i);  // NOLINT
+            }
+        }
+    }
+}
+
+void test_runtime_hasher() {
+    std::mt19937_64 gen{7};  // NOLINT
+    auto chunks = random_chunks(300, gen);
+    auto expected = expected_root(chunks, LIST_LIMIT);
+    auto process_impl = HashTree::hasher().impl();
+    for (auto impl : Hasher::available()) {
+        auto current = HashTree::hasher().impl();
+        {
+            ScopedHasher scoped{impl};
+            TEST_CHECK(HashTree::hasher().impl() == impl);
+            TEST_CHECK(expected_root(chunks, LIST_LIMIT) == expected);
+            TEST_MSG("implementation: %s", Hasher::name(impl).data());
+        }
+        TEST_CHECK(HashTree::hasher().impl() == current);
+
+        HashTree::hasher(impl);
+        TEST_CHECK(HashTree::hasher().impl() == impl);
+        TEST_CHECK(expected_root(chunks, LIST_LIMIT) == expected);
+    }
+    HashTree::hasher(process_impl);
+}
+
+void test_hash_stats() {
+    std::mt19937_64 gen{8};  // NOLINT
+    constexpr std::size_t width = 8, count = 100;
+    auto chunks = random_chunks(count * width, gen);
+    std::vector<Chunk> roots(count);
+    HashStats::reset();
+    {
+        HashStats::TypeScope scope{typeid(Merkleizer)};  // as Container::hash_tree_root() does
+        merkleize_many(chunks.data(), count, width, roots.data());
+    }
+    auto stats = HashStats::snapshot();
+    if (!HashStats::enabled) {
+        TEST_CHECK(stats.calls == 0 && stats.blocks == 0);
+        return;
+    }
+    // Each tree of 8 chunks hashes 4 + 2 + 1 blocks
+    TEST_CHECK(stats.blocks == count * (width - 1));
+    TEST_CHECK(std::accumulate(stats.histogram.cbegin(), stats.histogram.cend(), std::uint64_t{0}) == stats.calls);
+    TEST_CHECK(stats.untracked_blocks == 0);
+    TEST_ASSERT(stats.types.size() == 1);
+    TEST_CHECK(stats.types[0].roots == 1);
+    TEST_CHECK(stats.types[0].calls == stats.calls);
+    TEST_CHECK(stats.types[0].blocks == stats.blocks);
+    TEST_CHECK(stats.types[0].type == "ssz::Merkleizer");
+
+    HashStats::reset();
+    TEST_CHECK(HashStats::snapshot().calls == 0 && HashStats::snapshot().types.empty());
+}
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+TEST_LIST = {{"cache_full_rebuild", test_cache_full_rebuild},
+             {"cache_updates", test_cache_updates},
+             {"cache_resize", test_cache_resize},
+             {"merkleizer", test_merkleizer},
+             {"merkleizer_pack", test_merkleizer_pack},
+             {"parallel_merkleization", test_parallel_merkleization},
+             {"parallel_for_exception", test_parallel_for_exception},
+             {"merkleize_many", test_merkleize_many},
+             {"runtime_hasher", test_runtime_hasher},
+             {"hash_stats", test_hash_stats},
+             {NULL, NULL}};
@@ -19,6 +19,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <vector>
@@ -101,8 +102,6 @@ constexpr std::array<std::uint8_t, AVX2_MAX_LANES * BYTES_PER_CHUNK> test_8_dige
 
 using namespace ssz;
 
-const auto HashTree::hasher = Hasher{};
-
 void test_hash_sse_1() {
     auto impl = Hasher::implemented();
     if (!!(impl & Hasher::IMPL::SSE)) {
@@ -147,9 +146,72 @@ void test_hash_shani() {
     }
 }
 
+void test_hash_shani_x4() {
+    auto impl = Hasher::implemented();
+    if (!!(impl & Hasher::IMPL::SHA_X4)) {
+        Hasher hasher{Hasher::IMPL::SHA_X4};
+        std::array<std::uint8_t, AVX2_MAX_LANES * BYTES_PER_CHUNK> digest{};
+        hasher.hash_64b_blocks(digest.begin(), test_8_block.begin(), AVX2_MAX_LANES);
+        TEST_CHECK(digest == test_8_digests);  // NOLINT
+
+        // Seven blocks go through the four, two and one lane paths
+        digest = {};
+        hasher.hash_64b_blocks(digest.begin(), test_8_block.begin(), AVX2_MAX_LANES - 1);
+        TEST_CHECK(std::equal(digest.begin(), digest.end() - BYTES_PER_CHUNK, test_8_digests.begin()));  // NOLINT
+        TEST_CHECK(std::all_of(digest.end() - BYTES_PER_CHUNK, digest.end(), [](auto b) { return b == 0; }));
+    }
+}
+
+void test_hash_generic() {
+    Hasher hasher{Hasher::IMPL::GENERIC};
+    std::array<std::uint8_t, AVX2_MAX_LANES * BYTES_PER_CHUNK> digest{};
+    hasher.hash_64b_blocks(digest.begin(), test_8_block.begin(), AVX2_MAX_LANES);
+
+    TEST_CHECK(digest == test_8_digests);  // NOLINT
+}
+
+// Every kernel built for this CPU agrees with the C++ one on any number of blocks
+void test_hash_cross_check() {
+    constexpr std::size_t max_blocks = 19;
+    std::vector<std::uint8_t> input(max_blocks * SHA256_BLOCK_SIZE);
+    for (std::size_t i = 0; i < input.size(); ++i) input[i] = test_8_block[i % test_8_block.size()] ^ (i / 251);
+
+    Hasher generic{Hasher::IMPL::GENERIC};
+    auto impl = Hasher::implemented();
+    for (auto candidate : {Hasher::IMPL::SSE, Hasher::IMPL::AVX, Hasher::IMPL::AVX2, Hasher::IMPL::SHA,
+                           Hasher::IMPL::SHA_X4, Hasher::IMPL::SSE41, Hasher::IMPL::AVX2_CXX}) {
+        if (!(impl & candidate)) continue;
+        Hasher hasher{candidate};
+        for (std::size_t blocks = 1; blocks <= max_blocks; ++blocks) {
+            std::vector<std::uint8_t> expected(blocks * BYTES_PER_CHUNK), digest(blocks * BYTES_PER_CHUNK);
+            generic.hash_64b_blocks(expected.data(), input.data(), blocks);
+            hasher.hash_64b_blocks(digest.data(), input.data(), blocks);
+            TEST_CHECK(digest == expected);  // NOLINT
+            TEST_MSG("implementation %d, %zu blocks", static_cast<int>(candidate), blocks);
+        }
+    }
+}
+
+void test_hasher_registry() {
+    auto available = Hasher::available();
+    TEST_CHECK(!available.empty());
+    TEST_CHECK(available.front() == Hasher::best_implementation());
+    TEST_CHECK(available.back() == Hasher::IMPL::GENERIC);
+    for (auto impl : available) {
+        TEST_CHECK(Hasher::from_name(Hasher::name(impl)) == impl);
+        TEST_CHECK(Hasher::instance(impl).impl() == impl);
+    }
+    TEST_CHECK(Hasher::from_name("MD5") == Hasher::IMPL::NONE);
+    TEST_CHECK(Hasher::instance(Hasher::IMPL::NONE).impl() == Hasher::best_implementation());
+}
+
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 TEST_LIST = {{"hash_avx_1", test_hash_sse_1},
              {"hash_avx_4", test_hash_avx_4},
              {"hash_avx2_8", test_hash_avx2_8},
              {"hash_shani", test_hash_shani},
+             {"hash_shani_x4", test_hash_shani_x4},
+             {"hash_generic", test_hash_generic},
+             {"hash_cross_check", test_hash_cross_check},
+             {"hasher_registry", test_hasher_registry},
              {NULL, NULL}};
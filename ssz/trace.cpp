@@ -0,0 +1,217 @@
+/*  trace.cpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ssz/trace.hpp"
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <utility>
+
+namespace {
+using ssz::Trace;
+
+struct Event {
+    const char *operation;
+    std::type_index type;
+    std::uint32_t thread;
+    std::int64_t start, duration;  // ns since the trace started
+    std::uint64_t allocations, bytes;
+};
+
+struct Sums {
+    std::uint64_t calls, nanoseconds, allocations, bytes, self_allocations, self_bytes;
+};
+
+using Key = std::pair<std::string_view, std::type_index>;
+
+// Scopes are only recorded when they end, under the mutex
+std::mutex mutex;                                       // NOLINT
+std::vector<Event> events;                              // NOLINT
+std::size_t max_events = 0, dropped_events = 0;         // NOLINT
+std::map<Key, Sums> types, operations;                  // NOLINT
+std::chrono::steady_clock::time_point epoch;            // NOLINT
+std::atomic<std::uint32_t> thread_count{0};             // NOLINT
+thread_local std::uint32_t thread_id = thread_count++;  // NOLINT
+
+std::string demangle(const char *name) {
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> demangled{abi::__cxa_demangle(name, nullptr, nullptr, &status),
+                                                          &std::free};
+    return status == 0 ? demangled.get() : name;
+}
+
+std::vector<Trace::Totals> sorted(const std::map<Key, Sums> &totals) {
+    std::vector<Trace::Totals> ret;
+    for (const auto &[key, t] : totals)
+        ret.push_back({std::string(key.first), demangle(key.second.name()), t.calls, t.nanoseconds, t.allocations,
+                       t.bytes, t.self_allocations, t.self_bytes});
+    std::stable_sort(ret.begin(), ret.end(), [](const auto &a, const auto &b) { return a.bytes > b.bytes; });
+    return ret;
+}
+
+// Type names are written in JSON strings
+std::string escape(const std::string &str) {
+    std::string ret;
+    for (auto c : str) {
+        if (c == '"' || c == '\\') ret += '\\';
+        ret += c;
+    }
+    return ret;
+}
+}  // namespace
+
+namespace ssz {
+void Trace::start(std::size_t max) {
+    std::lock_guard lock{mutex};
+    max_events = max;
+    if (events.empty() && types.empty()) epoch = std::chrono::steady_clock::now();
+    active_ = true;
+}
+
+void Trace::stop() { active_ = false; }
+
+void Trace::reset() {
+    std::lock_guard lock{mutex};
+    events.clear();
+    types.clear();
+    operations.clear();
+    dropped_events = 0;
+    epoch = std::chrono::steady_clock::now();
+}
+
+void Trace::Scope::begin() {
+    parent_ = scope_;
+    scope_ = this;
+    allocations_ = Trace::allocations_;
+    bytes_ = Trace::bytes_;
+    start_ = std::chrono::steady_clock::now();
+}
+
+void Trace::Scope::end() {
+    auto finish = std::chrono::steady_clock::now();
+    const auto allocations = Trace::allocations_ - allocations_, bytes = Trace::bytes_ - bytes_;
+    scope_ = parent_;
+    if (parent_) {
+        parent_->nested_allocations_ += allocations;
+        parent_->nested_bytes_ += bytes;
+    }
+
+    // The counters are only read as differences, the allocations made here to record the scope are taken back
+    const auto saved_allocations = Trace::allocations_, saved_bytes = Trace::bytes_;
+    {
+        const std::int64_t duration = std::chrono::nanoseconds(finish - start_).count();
+        std::lock_guard lock{mutex};
+        auto add = [&](Sums &t) {
+            ++t.calls;
+            t.nanoseconds += duration;
+            t.allocations += allocations;
+            t.bytes += bytes;
+            t.self_allocations += allocations - nested_allocations_;
+            t.self_bytes += bytes - nested_bytes_;
+        };
+        add(types[{operation_, type_}]);
+        if (!parent_) add(operations[{operation_, type_}]);
+        if (events.size() < max_events)
+            events.push_back({operation_, type_, thread_id, std::chrono::nanoseconds(start_ - epoch).count(), duration,
+                              allocations, bytes});
+        else
+            ++dropped_events;
+    }
+    Trace::allocations_ = saved_allocations;
+    Trace::bytes_ = saved_bytes;
+}
+
+Trace::Snapshot Trace::snapshot() {
+    std::lock_guard lock{mutex};
+    return {sorted(types), sorted(operations), events.size(), dropped_events};
+}
+
+void Trace::dump(std::ostream &os) {
+    if (!enabled) {
+        os << "tracing is disabled, build with -DSSZ_TRACE=ON\n";
+        return;
+    }
+    auto stats = snapshot();
+    auto table = [&](const char *title, const std::vector<Totals> &totals) {
+        os << title << '\n'
+           << std::setw(10) << "Calls" << std::setw(12) << "Time (ms)" << std::setw(12) << "Allocs" << std::setw(14)
+           << "Bytes" << std::setw(12) << "Self allocs" << std::setw(14) << "Self bytes"
+           << "  Operation Type\n";
+        for (const auto &t : totals)
+            os << std::setw(10) << t.calls << std::setw(12) << std::fixed << std::setprecision(3)
+               << double(t.nanoseconds) / 1e6 << std::setw(12) << t.allocations << std::setw(14) << t.bytes  // NOLINT
+               << std::setw(12) << t.self_allocations << std::setw(14) << t.self_bytes << "  " << t.operation << ' '
+               << t.type << '\n';
+    };
+    table("Top-level operations:", stats.operations);
+    table("By type:", stats.types);
+    if (stats.dropped_events) os << stats.dropped_events << " events were not kept\n";
+    os.unsetf(std::ios::fixed);
+}
+
+void Trace::write_chrome_trace(std::ostream &os) {
+    std::lock_guard lock{mutex};
+    std::map<std::type_index, std::string> names;
+    os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const auto &e = events[i];
+        auto name = names.find(e.type);
+        if (name == names.end()) name = names.emplace(e.type, escape(demangle(e.type.name()))).first;
+        os << (i ? ",\n" : "\n") << "{\"name\": \"" << e.operation << ' ' << name->second
+           << "\", \"cat\": \"" << e.operation << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.thread
+           << std::fixed << std::setprecision(3) << ", \"ts\": " << double(e.start) / 1e3  // NOLINT
+           << ", \"dur\": " << double(e.duration) / 1e3 << ", \"args\": {\"allocations\": " << e.allocations  // NOLINT
+           << ", \"bytes\": " << e.bytes << "}}";
+    }
+    os << "\n]}\n";
+    os.unsetf(std::ios::fixed);
+}
+}  // namespace ssz
+
+#ifdef SSZ_TRACE
+// The containers allocate through std::allocator, replacing the global allocation functions counts all of it
+void *operator new(std::size_t size) {
+    ssz::Trace::count_allocation(size);
+    if (auto *ptr = std::malloc(size ? size : 1)) return ptr;  // NOLINT
+    throw std::bad_alloc{};
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+    ssz::Trace::count_allocation(size);
+    const auto alignment = std::max(static_cast<std::size_t>(align), sizeof(void *));
+    const auto rounded = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    if (auto *ptr = std::aligned_alloc(alignment, rounded)) return ptr;  // NOLINT
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }                          // NOLINT
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }             // NOLINT
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }        // NOLINT
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }  // NOLINT
+#endif
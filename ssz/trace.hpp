@@ -0,0 +1,113 @@
+/*  trace.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+namespace ssz {
+/**
+ *   \brief Wall time and heap allocations of serialize, deserialize and hash_tree_root by SSZ type.
+ *   \details Only built with SSZ_TRACE, see CMakeLists.txt, otherwise SSZ_TRACE_SCOPE is empty and nothing is
+ *   recorded. Each scope between start() and stop() records an event, exported in the Chrome trace-event format, and
+ *   is added to the totals of its type and operation, and to those of the top-level operation if it is the outermost
+ *   on its thread. Allocations are whatever is passed to count_allocation() on the thread while in scope, the tracing
+ *   build replaces the global operator new to call it, an allocator or memory resource may call it as well. Leaf types
+ *   (Bytes, Slot, Boolean) never allocate and are not traced, bitvectors are traced as bitlists.
+ */
+class Trace {
+   public:
+#ifdef SSZ_TRACE
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    struct Totals {
+        std::string operation, type;
+        std::uint64_t calls, nanoseconds, allocations, bytes;
+        std::uint64_t self_allocations, self_bytes;  // excluding the nested scopes
+    };
+
+    struct Snapshot {
+        std::vector<Totals> types;       // every scope, by operation and type, most bytes first
+        std::vector<Totals> operations;  // outermost scopes only
+        std::size_t events, dropped_events;
+    };
+
+    static void start(std::size_t max_events = 1U << 20U);  // NOLINT
+    static void stop();
+    static bool active() { return active_.load(std::memory_order_relaxed); }
+    static void reset();
+
+    static Snapshot snapshot();
+    static void dump(std::ostream &os);
+    // {"traceEvents": [...]} with a complete ("X") event per scope, load it in chrome://tracing or Perfetto
+    static void write_chrome_trace(std::ostream &os);
+
+    static void count_allocation(std::size_t bytes) noexcept {
+        ++allocations_;
+        bytes_ += bytes;
+    }
+
+    class Scope {
+       private:
+        const char *operation_;
+        std::type_index type_;
+        bool active_;
+        Scope *parent_ = nullptr;
+        std::uint64_t allocations_ = 0, bytes_ = 0, nested_allocations_ = 0, nested_bytes_ = 0;
+        std::chrono::steady_clock::time_point start_;
+
+        void begin();
+        void end();
+
+       public:
+        Scope(const char *operation, std::type_index type) : operation_{operation}, type_{type}, active_{active()} {
+            if (active_) begin();
+        }
+        ~Scope() {
+            if (active_) end();
+        }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+   private:
+    inline static std::atomic<bool> active_{false};
+    inline static thread_local std::uint64_t allocations_ = 0, bytes_ = 0;
+    inline static thread_local Scope *scope_ = nullptr;
+};
+}  // namespace ssz
+
+// Traces the rest of the enclosing member function as operation on the dynamic type of *this
+#ifdef SSZ_TRACE
+#define SSZ_TRACE_SCOPE(operation) const ssz::Trace::Scope ssz_trace_scope_{operation, typeid(*this)}
+#else
+#define SSZ_TRACE_SCOPE(operation)
+#endif
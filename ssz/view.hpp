@@ -0,0 +1,198 @@
+/*  view.hpp
+ *
+ *  This file is part of Mammon.
+ *  mammon is a greedy and selfish ETH consensus client.
+ *
+ *  Copyright (c) 2021 - Reimundo Heluani (potuz) potuz@potuz.net
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "helpers/bytes_to_int.hpp"
+#include "ssz/schema.hpp"
+#include "ssz/ssz.hpp"
+
+namespace ssz {
+
+namespace detail {
+struct FieldLayout {
+    std::size_t position;
+    bool fixed;
+};
+
+// Positions of the fields of T in the fixed part, followed by a sentinel at the end of the fixed part
+template <class T>
+constexpr auto field_layout() {
+    return []<std::size_t... I>(std::index_sequence<I...>) {
+        std::array<FieldLayout, sizeof...(I) + 1> ret{FieldLayout{0, FixedSized<field_t<T, I>>}...,
+                                                      FieldLayout{0, true}};
+        std::array<std::size_t, sizeof...(I)> sizes{fixed_part_size<field_t<T, I>>()...};
+        for (std::size_t i = 1; i < ret.size(); ++i) ret[i].position = ret[i - 1].position + sizes[i - 1];
+        return ret;
+    }
+    (std::make_index_sequence<field_count<T>>{});
+}
+
+// Lists, whose limit is not part of their encoding but set by the container that holds them
+template <class T>
+concept Limited = requires(T value, const T &list) {
+    { list.limit() } -> std::convertible_to<std::size_t>;
+    value.limit(std::size_t{});
+};
+
+// The limits that T gives to its list fields, 0 for the other fields. They are read once from a default T, which is
+// then released as it may be large.
+template <class T>
+const auto &field_limits() {
+    static const auto limits = [] {
+        std::array<std::size_t, field_count<T>> ret{};
+        auto parent = std::make_unique<const T>();
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            auto limit = [](const auto &field) -> std::size_t {
+                if constexpr (Limited<std::remove_cvref_t<decltype(field)>>)
+                    return field.limit();
+                else
+                    return 0;
+            };
+            ((ret[I] = limit((*parent).*(std::get<I>(T::fields()).member))), ...);
+        }
+        (std::make_index_sequence<field_count<T>>{});
+        return ret;
+    }();
+    return limits;
+}
+}  // namespace detail
+
+/**
+ *   \brief A read-only view of the SSZ encoding of a T.
+ *   \details Fields of containers that declare fields() and elements of lists are located in place, without
+ *   copying or allocating, so that a single value can be read from a large serialized object. Offsets are checked
+ *   against the underlying buffer, which must outlive the view, and std::out_of_range is thrown when they do not fit.
+ */
+template <class T>
+class View {
+   private:
+    std::span<const std::uint8_t> data_;
+    std::optional<std::size_t> limit_;  // of a list field, given to the materialized list
+
+    std::span<const std::uint8_t> slice(std::size_t first, std::size_t last) const {
+        if (first > last || last > data_.size()) throw std::out_of_range("SSZ view out of bounds");
+        return data_.subspan(first, last - first);
+    }
+
+    std::size_t offset_at(std::size_t position) const {
+        slice(position, position + constants::BYTES_PER_LENGTH_OFFSET);
+        return helpers::to_integer_little_endian<std::uint32_t>(data_.data() + position);
+    }
+
+   public:
+    constexpr View() = default;
+    explicit constexpr View(std::span<const std::uint8_t> data, std::optional<std::size_t> limit = std::nullopt)
+        : data_{data}, limit_{limit} {}
+
+    constexpr std::span<const std::uint8_t> bytes() const noexcept { return data_; }
+
+    // Field I of a container, variable sized fields extend up to the next offset or the end of the buffer
+    template <std::size_t I>
+    requires HasFields<T> auto get() const {
+        using F = field_t<T, I>;
+        constexpr auto layout = detail::field_layout<T>();
+
+        if constexpr (FixedSized<F>)
+            return View<F>{slice(layout[I].position, layout[I].position + F::ssz_size)};
+        else {
+            auto last = data_.size();
+            for (auto j = I + 1; j < layout.size() - 1; ++j)
+                if (!layout[j].fixed) {
+                    last = offset_at(layout[j].position);
+                    break;
+                }
+            std::optional<std::size_t> limit;
+            if constexpr (detail::Limited<F>) limit = detail::field_limits<T>()[I];
+            return View<F>{slice(offset_at(layout[I].position), last), limit};
+        }
+    }
+
+    // Number of elements of a list or vector, throws std::invalid_argument if the bytes cannot hold whole elements
+    // or the first offset does not end a table of offsets within them
+    std::size_t size() const requires Sequence<T> {
+        using E = typename T::value_type;
+        if constexpr (FixedSized<E>) {
+            if (data_.size() % E::ssz_size) throw std::invalid_argument("malformed SSZ");
+            return data_.size() / E::ssz_size;
+        } else {
+            if (data_.empty()) return 0;
+            auto first = offset_at(0);
+            if (!first || first % constants::BYTES_PER_LENGTH_OFFSET || first > data_.size())
+                throw std::invalid_argument("malformed SSZ");
+            return first / constants::BYTES_PER_LENGTH_OFFSET;
+        }
+    }
+
+    auto operator[](std::size_t index) const requires Sequence<T> {
+        using E = typename T::value_type;
+        if constexpr (FixedSized<E>)
+            return View<E>{slice(index * E::ssz_size, (index + 1) * E::ssz_size)};
+        else {
+            auto last = index + 1 < size() ? offset_at((index + 1) * constants::BYTES_PER_LENGTH_OFFSET)
+                                           : data_.size();
+            return View<E>{slice(offset_at(index * constants::BYTES_PER_LENGTH_OFFSET), last)};
+        }
+    }
+
+    // Builds an owned T from the viewed bytes. Integers and byte arrays are read in place, anything else is
+    // deserialized from a copy and throws std::invalid_argument if malformed. List limits are not part of the
+    // encoding: fields taken with get() have those of their container, other lists keep their defaults.
+    T materialize() const {
+        if constexpr (FixedSized<T>) {
+            if (data_.size() != T::ssz_size) throw std::invalid_argument("malformed SSZ");
+            if constexpr (T::ssz_size == sizeof(std::uint64_t) && std::is_convertible_v<T, std::uint64_t>)
+                return T{helpers::to_integer_little_endian<std::uint64_t>(data_.data())};
+            if constexpr (std::is_constructible_v<T, std::array<std::uint8_t, T::ssz_size>>) {
+                std::array<std::uint8_t, T::ssz_size> arr;  // NOLINT
+                std::copy(data_.begin(), data_.end(), arr.begin());
+                return T{arr};
+            }
+        }
+        T ret{};
+        materialize(ret);
+        return ret;
+    }
+
+    // As materialize(), into out, for containers such as a BeaconState that are too large for the stack. The lists
+    // of out keep their limits, unless the view is a field taken with get().
+    void materialize(T &out) const {
+        if constexpr (FixedSized<T>)
+            if (data_.size() != T::ssz_size) throw std::invalid_argument("malformed SSZ");
+        if constexpr (detail::Limited<T>)
+            if (limit_) out.limit(*limit_);
+        std::vector<std::uint8_t> buffer(data_.begin(), data_.end());
+        if (!out.deserialize(buffer.cbegin(), buffer.cend())) throw std::invalid_argument("malformed SSZ");
+    }
+};
+}  // namespace ssz